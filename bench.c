@@ -0,0 +1,544 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <glib.h>
+#include <glib-object.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "myobject.h"
+#include "myobject-inline.h"
+#include "memcount.h"
+
+/*
+ * Microbenchmarks for the MyObject hot paths.
+ *
+ * Every benchmark runs BENCH_SAMPLES timed batches of a fixed number of
+ * operations after one untimed warm-up batch. The per-batch ns/op values
+ * give the percentiles; allocations are counted over all timed batches.
+ * Results are written to stdout (or --output FILE) as JSON, one benchmark
+ * per line, so runs from different releases can be diffed directly.
+ *
+ * With --baseline FILE, the medians are also compared against those of an
+ * earlier run, and the program fails if any benchmark got slower by more
+ * than --max-regression percent (BENCH_MAX_REGRESSION by default).
+ */
+
+#define BENCH_SAMPLES 51
+#define BENCH_BATCH 10000
+#define BENCH_MANY_HANDLERS 8
+#define BENCH_MANY_WATCHES 1000
+#define FOOTPRINT_INSTANCES 1000000
+#define BENCH_MAX_REGRESSION 25.0
+
+typedef struct {
+    MyObject *obj;
+    gint counter;
+} BenchState;
+
+typedef struct {
+    const gchar *name;
+    void (*setup) (BenchState *state);
+    void (*run) (BenchState *state, guint n_ops);
+} Benchmark;
+
+static void
+on_value_changed_noop (MyObject *obj, gint new_value, gpointer user_data)
+{
+}
+
+static gint64
+bench_now_ns (void)
+{
+    struct timespec ts;
+    
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (gint64) ts.tv_sec * G_GINT64_CONSTANT (1000000000) + ts.tv_nsec;
+}
+
+/* Setup functions */
+
+static void
+setup_object (BenchState *state)
+{
+    state->obj = my_object_new_with_value (1);
+    my_object_set_name (state->obj, "benchmark");
+}
+
+static void
+setup_one_handler (BenchState *state)
+{
+    setup_object (state);
+    g_signal_connect (state->obj, "value-changed",
+                      G_CALLBACK (on_value_changed_noop), NULL);
+}
+
+static void
+setup_many_handlers (BenchState *state)
+{
+    guint i;
+    
+    setup_object (state);
+    for (i = 0; i < BENCH_MANY_HANDLERS; i++) {
+        g_signal_connect (state->obj, "value-changed",
+                          G_CALLBACK (on_value_changed_noop), NULL);
+    }
+}
+
+static void
+on_watch_noop (MyObject *obj, gint value, gpointer user_data)
+{
+}
+
+/* Thresholds below every value the benchmarks set, so none fire */
+static void
+setup_many_watches (BenchState *state)
+{
+    gint i;
+    
+    setup_object (state);
+    for (i = 0; i < BENCH_MANY_WATCHES; i++)
+        my_object_add_watch (state->obj, MY_WATCH_ABOVE, -1 - i,
+                             on_watch_noop, NULL, NULL);
+}
+
+/* Benchmark bodies */
+
+static void
+run_new (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_unref (my_object_new ());
+}
+
+static void
+run_new_with_value (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_unref (my_object_new_with_value ((gint) i));
+}
+
+static void
+run_new_full (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_unref (my_object_new_full ((gint) i, "benchmark"));
+}
+
+static void
+run_new_many (BenchState *state, guint n_ops)
+{
+    gint *values = g_new (gint, n_ops);
+    const gchar **names = g_new (const gchar *, n_ops);
+    guint i;
+    
+    for (i = 0; i < n_ops; i++) {
+        values[i] = (gint) i;
+        names[i] = "benchmark";
+    }
+    g_ptr_array_unref (my_object_new_many (values, names, n_ops));
+    
+    g_free (names);
+    g_free (values);
+}
+
+static void
+run_get_value (BenchState *state, guint n_ops)
+{
+    guint i;
+    gint total = 0;
+    
+    for (i = 0; i < n_ops; i++)
+        total += my_object_get_value (state->obj);
+    state->counter += total;
+}
+
+static void
+run_get_value_fast (BenchState *state, guint n_ops)
+{
+    guint i;
+    gint total = 0;
+    
+    for (i = 0; i < n_ops; i++)
+        total += my_object_get_value_fast (state->obj);
+    state->counter += total;
+}
+
+static void
+run_set_value (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        my_object_set_value (state->obj, state->counter++);
+}
+
+static void
+run_set_name (BenchState *state, guint n_ops)
+{
+    static const gchar *names[] = {
+        "short-a",
+        "short-b",
+        "a name that is too long to be stored inline",
+        "another name that is too long to be stored inline",
+    };
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        my_object_set_name (state->obj, names[i % G_N_ELEMENTS (names)]);
+}
+
+static void
+run_to_string (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_free (my_object_to_string (state->obj));
+}
+
+static void
+run_peek_string (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        my_object_peek_string (state->obj);
+}
+
+static void
+run_format_to_buffer (BenchState *state, guint n_ops)
+{
+    gchar buf[64];
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        my_object_format_to_buffer (state->obj, buf, sizeof buf);
+}
+
+static void
+run_property_get (BenchState *state, guint n_ops)
+{
+    guint i;
+    gint value;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_get (state->obj, "value", &value, NULL);
+}
+
+static void
+run_property_set (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_set (state->obj, "value", state->counter++, NULL);
+}
+
+static void
+run_ref_unref (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    for (i = 0; i < n_ops; i++)
+        g_object_unref (g_object_ref (state->obj));
+}
+
+static void
+run_batch_update (BenchState *state, guint n_ops)
+{
+    guint i;
+    
+    gboolean batched = my_object_begin_update (state->obj);
+    
+    for (i = 0; i < n_ops; i++)
+        my_object_increment (state->obj);
+    if (batched)
+        my_object_end_update (state->obj);
+}
+
+static const Benchmark benchmarks[] = {
+    { "new",                   NULL,                run_new },
+    { "new_with_value",        NULL,                run_new_with_value },
+    { "new_full",              NULL,                run_new_full },
+    { "new_many",              NULL,                run_new_many },
+    { "get_value",             setup_object,        run_get_value },
+    { "get_value_fast",        setup_object,        run_get_value_fast },
+    { "set_value",             setup_object,        run_set_value },
+    { "set_value_1_handler",   setup_one_handler,   run_set_value },
+    { "set_value_8_handlers",  setup_many_handlers, run_set_value },
+    { "set_value_1000_watches", setup_many_watches, run_set_value },
+    { "set_name",              setup_object,        run_set_name },
+    { "to_string",             setup_object,        run_to_string },
+    { "peek_string",           setup_object,        run_peek_string },
+    { "format_to_buffer",      setup_object,        run_format_to_buffer },
+    { "property_get",          setup_object,        run_property_get },
+    { "property_set",          setup_object,        run_property_set },
+    { "ref_unref",             setup_object,        run_ref_unref },
+    { "batch_increment",       setup_object,        run_batch_update },
+};
+
+static int
+compare_double (gconstpointer a, gconstpointer b)
+{
+    gdouble x = *(const gdouble *) a;
+    gdouble y = *(const gdouble *) b;
+    
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of a sorted sample array */
+static gdouble
+percentile (const gdouble *sorted, guint n, gdouble p)
+{
+    guint rank = (guint) (p * (n - 1) + 0.5);
+    
+    return sorted[MIN (rank, n - 1)];
+}
+
+/* Returns the median ns/op */
+static gdouble
+run_benchmark (const Benchmark *bench, guint batch, FILE *out, gboolean last)
+{
+    BenchState state = { NULL, 0 };
+    gdouble samples[BENCH_SAMPLES];
+    guint64 n_allocs;
+    guint i;
+    
+    if (bench->setup)
+        bench->setup (&state);
+    
+    /* Warm caches, type data and lazily created class state */
+    bench->run (&state, batch);
+    
+    memcount_begin ();
+    for (i = 0; i < BENCH_SAMPLES; i++) {
+        gint64 start = bench_now_ns ();
+        bench->run (&state, batch);
+        samples[i] = (gdouble) (bench_now_ns () - start) / batch;
+    }
+    n_allocs = memcount_end ();
+    
+    qsort (samples, BENCH_SAMPLES, sizeof samples[0], compare_double);
+    
+    fprintf (out,
+             "    {\"name\": \"%s\", \"ops\": %u, "
+             "\"ns_per_op\": {\"min\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f}, "
+             "\"allocs_per_op\": %.3f}%s\n",
+             bench->name, batch * BENCH_SAMPLES,
+             samples[0],
+             percentile (samples, BENCH_SAMPLES, 0.50),
+             percentile (samples, BENCH_SAMPLES, 0.90),
+             percentile (samples, BENCH_SAMPLES, 0.99),
+             memcount_available () ? (gdouble) n_allocs / (batch * BENCH_SAMPLES) : -1.0,
+             last ? "" : ",");
+    
+    g_clear_object (&state.obj);
+    
+    return percentile (samples, BENCH_SAMPLES, 0.50);
+}
+
+/* Reads the medians of an earlier run, one benchmark per line as written
+ * by run_benchmark(), into a table from name to p50 */
+static GHashTable *
+load_baseline (const gchar *path)
+{
+    GHashTable *medians;
+    gchar *contents;
+    gchar **lines;
+    GError *error = NULL;
+    
+    if (!g_file_get_contents (path, &contents, NULL, &error)) {
+        fprintf (stderr, "Cannot read baseline: %s\n", error->message);
+        g_error_free (error);
+        return NULL;
+    }
+    
+    medians = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    lines = g_strsplit (contents, "\n", -1);
+    
+    for (guint i = 0; lines[i]; i++) {
+        const gchar *name = strstr (lines[i], "\"name\": \"");
+        const gchar *p50 = strstr (lines[i], "\"p50\": ");
+        const gchar *end;
+        gdouble *median;
+        
+        if (!name || !p50)
+            continue;
+        
+        name += strlen ("\"name\": \"");
+        end = strchr (name, '"');
+        if (!end)
+            continue;
+        
+        median = g_new (gdouble, 1);
+        *median = g_ascii_strtod (p50 + strlen ("\"p50\": "), NULL);
+        g_hash_table_replace (medians, g_strndup (name, end - name), median);
+    }
+    
+    g_strfreev (lines);
+    g_free (contents);
+    
+    return medians;
+}
+
+/* Resident set size in bytes, or -1 where /proc is not available */
+static gint64
+resident_bytes (void)
+{
+    FILE *statm = fopen ("/proc/self/statm", "r");
+    long size, resident;
+    gint64 bytes = -1;
+    
+    if (!statm)
+        return -1;
+    if (fscanf (statm, "%ld %ld", &size, &resident) == 2)
+        bytes = (gint64) resident * sysconf (_SC_PAGESIZE);
+    fclose (statm);
+    
+    return bytes;
+}
+
+/* Reports the memory cost of many live instances instead of timings */
+static void
+run_footprint (FILE *out)
+{
+    MyObject **objects = g_new (MyObject *, FOOTPRINT_INSTANCES);
+    GTypeQuery query;
+    gint64 rss_before, rss_after;
+    guint64 n_allocs, n_bytes;
+    guint i;
+    
+    g_type_query (MY_TYPE_OBJECT, &query);
+    
+    /* Class and type data are allocated by the first instance */
+    g_object_unref (my_object_new ());
+    
+    rss_before = resident_bytes ();
+    memcount_begin ();
+    for (i = 0; i < FOOTPRINT_INSTANCES; i++)
+        objects[i] = my_object_new_with_value ((gint) i);
+    n_allocs = memcount_end ();
+    n_bytes = memcount_get_bytes ();
+    rss_after = resident_bytes ();
+    
+    fprintf (out,
+             "{\n  \"library\": \"myobject\",\n  \"instances\": %d,\n"
+             "  \"sizeof_instance\": %u,\n  \"type_instance_size\": %u,\n"
+             "  \"allocs_per_instance\": %.3f,\n  \"heap_bytes_per_instance\": %.1f,\n"
+             "  \"rss_bytes_per_instance\": %.1f\n}\n",
+             FOOTPRINT_INSTANCES, (guint) sizeof (MyObject), query.instance_size,
+             memcount_available () ? (gdouble) n_allocs / FOOTPRINT_INSTANCES : -1.0,
+             memcount_available () ? (gdouble) n_bytes / FOOTPRINT_INSTANCES : -1.0,
+             rss_before >= 0 && rss_after >= 0 ?
+                 (gdouble) (rss_after - rss_before) / FOOTPRINT_INSTANCES : -1.0);
+    
+    for (i = 0; i < FOOTPRINT_INSTANCES; i++)
+        g_object_unref (objects[i]);
+    g_free (objects);
+}
+
+int
+main (int argc, char *argv[])
+{
+    const gchar *output = NULL;
+    const gchar *filter = NULL;
+    const gchar *baseline_path = NULL;
+    GHashTable *baseline = NULL;
+    gdouble max_regression = BENCH_MAX_REGRESSION;
+    guint n_regressions = 0;
+    guint batch = BENCH_BATCH;
+    gboolean footprint = FALSE;
+    FILE *out = stdout;
+    guint i, n_selected = 0, n_done = 0;
+    
+    for (i = 1; i < (guint) argc; i++) {
+        if (strcmp (argv[i], "--output") == 0 && i + 1 < (guint) argc) {
+            output = argv[++i];
+        } else if (strcmp (argv[i], "--filter") == 0 && i + 1 < (guint) argc) {
+            filter = argv[++i];
+        } else if (strcmp (argv[i], "--baseline") == 0 && i + 1 < (guint) argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp (argv[i], "--max-regression") == 0 && i + 1 < (guint) argc) {
+            max_regression = g_ascii_strtod (argv[++i], NULL);
+        } else if (strcmp (argv[i], "--quick") == 0) {
+            batch = BENCH_BATCH / 10;
+        } else if (strcmp (argv[i], "--footprint") == 0) {
+            footprint = TRUE;
+        } else {
+            fprintf (stderr, "Usage: %s [--quick] [--footprint] [--filter SUBSTRING] [--output FILE]\n"
+                     "          [--baseline FILE [--max-regression PERCENT]]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    if (baseline_path) {
+        baseline = load_baseline (baseline_path);
+        if (!baseline)
+            return 1;
+    }
+    
+    if (output) {
+        out = fopen (output, "w");
+        if (!out) {
+            fprintf (stderr, "Cannot open %s for writing\n", output);
+            return 1;
+        }
+    }
+    
+    if (footprint) {
+        run_footprint (out);
+        if (out != stdout)
+            fclose (out);
+        return 0;
+    }
+    
+    for (i = 0; i < G_N_ELEMENTS (benchmarks); i++) {
+        if (!filter || strstr (benchmarks[i].name, filter))
+            n_selected++;
+    }
+    
+    fprintf (out, "{\n  \"library\": \"myobject\",\n  \"samples\": %d,\n"
+             "  \"allocs_counted\": %s,\n  \"benchmarks\": [\n",
+             BENCH_SAMPLES, memcount_available () ? "true" : "false");
+    
+    for (i = 0; i < G_N_ELEMENTS (benchmarks); i++) {
+        gdouble median, *expected;
+        
+        if (filter && !strstr (benchmarks[i].name, filter))
+            continue;
+        n_done++;
+        median = run_benchmark (&benchmarks[i], batch, out, n_done == n_selected);
+        
+        /* Benchmarks added since the baseline was taken are not checked */
+        expected = baseline ? g_hash_table_lookup (baseline, benchmarks[i].name) : NULL;
+        if (expected && median > *expected * (1.0 + max_regression / 100.0)) {
+            fprintf (stderr, "%s: median %.2f ns/op is %.0f%% slower than the baseline %.2f ns/op\n",
+                     benchmarks[i].name, median, (median / *expected - 1.0) * 100.0, *expected);
+            n_regressions++;
+        }
+    }
+    
+    fprintf (out, "  ]\n}\n");
+    
+    if (out != stdout)
+        fclose (out);
+    
+    if (baseline) {
+        g_hash_table_unref (baseline);
+        if (n_regressions > 0) {
+            fprintf (stderr, "%u benchmark(s) regressed by more than %.0f%%\n",
+                     n_regressions, max_regression);
+            return 1;
+        }
+    }
+    
+    return 0;
+}
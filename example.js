@@ -277,12 +277,167 @@ function performanceTest() {
   print(`Completed ${numOperations} operations in ${duration}ms`);
   print(`Performance: ~${opsPerSecond} operations per second`);
   print(`Final value: ${obj.get_value()}`);
+
+  // One add() call replaces a loop of increment() calls
+  obj.set_value(0);
+  startTime = Date.now();
+  obj.add(numOperations);
+  duration = Date.now() - startTime;
+  print(`Single add(${numOperations}) took ${duration}ms`);
+  print(`Value after add: ${obj.get_value()}`);
+}
+
+/*
+ * Benchmark mode: the same operation mix as bench.c, timed through GJS.
+ * Case names match bench.c so results can be joined by name.
+ */
+const BENCH_SAMPLES = 21;
+const BENCH_BATCH = 2000;
+const BENCH_MANY_HANDLERS = 8;
+
+function benchObject(nHandlers = 0) {
+  let obj = My.Object.new_with_value(1);
+  obj.set_name("benchmark");
+  for (let i = 0; i < nHandlers; i++) {
+    obj.connect("value-changed", () => {});
+  }
+  return obj;
+}
+
+function runSetValue(obj, n) {
+  let base = obj.get_value();
+  for (let i = 0; i < n; i++) obj.set_value(base + i + 1);
+}
+
+const BENCH_CASES = [
+  ["new", () => null, (obj, n) => {
+    for (let i = 0; i < n; i++) My.Object.new();
+  }],
+  ["new_with_value", () => null, (obj, n) => {
+    for (let i = 0; i < n; i++) My.Object.new_with_value(i);
+  }],
+  ["get_value", () => benchObject(), (obj, n) => {
+    for (let i = 0; i < n; i++) obj.get_value();
+  }],
+  ["set_value", () => benchObject(), runSetValue],
+  ["set_value_1_handler", () => benchObject(1), runSetValue],
+  ["set_value_8_handlers", () => benchObject(BENCH_MANY_HANDLERS), runSetValue],
+  ["set_name", () => benchObject(), (obj, n) => {
+    const names = [
+      "short-a",
+      "short-b",
+      "a name that is too long to be stored inline",
+      "another name that is too long to be stored inline",
+    ];
+    for (let i = 0; i < n; i++) obj.set_name(names[i % names.length]);
+  }],
+  ["to_string", () => benchObject(), (obj, n) => {
+    for (let i = 0; i < n; i++) obj.to_string();
+  }],
+  ["property_get", () => benchObject(), (obj, n) => {
+    for (let i = 0; i < n; i++) obj.value;
+  }],
+  ["property_set", () => benchObject(), (obj, n) => {
+    let base = obj.value;
+    for (let i = 0; i < n; i++) obj.value = base + i + 1;
+  }],
+  ["batch_increment", () => benchObject(), (obj, n) => {
+    obj.begin_update();
+    for (let i = 0; i < n; i++) obj.increment();
+    obj.end_update();
+  }],
+];
+
+function percentile(sorted, p) {
+  let rank = Math.floor(p * (sorted.length - 1) + 0.5);
+  return sorted[Math.min(rank, sorted.length - 1)];
+}
+
+/**
+ * Load {name: p50 ns/op} from a bench.c JSON file, or {} if unavailable
+ */
+function loadCResults(path) {
+  try {
+    let [, contents] = GLib.file_get_contents(path);
+    let data = JSON.parse(new TextDecoder().decode(contents));
+    let results = {};
+    for (let b of data.benchmarks) results[b.name] = b.ns_per_op.p50;
+    return results;
+  } catch (e) {
+    return {};
+  }
+}
+
+/**
+ * Time each API through GJS and compare against the C harness
+ */
+function runBenchmarks(cResultsPath, outputPath) {
+  let cResults = loadCResults(cResultsPath);
+  let results = [];
+
+  for (let [name, setup, run] of BENCH_CASES) {
+    let obj = setup();
+    run(obj, BENCH_BATCH); // warm-up
+
+    let samples = [];
+    for (let s = 0; s < BENCH_SAMPLES; s++) {
+      // GLib's monotonic clock has microsecond resolution, enough per batch
+      let start = GLib.get_monotonic_time();
+      run(obj, BENCH_BATCH);
+      samples.push(((GLib.get_monotonic_time() - start) * 1000) / BENCH_BATCH);
+    }
+    samples.sort((a, b) => a - b);
+
+    let p50 = percentile(samples, 0.5);
+    let cP50 = cResults[name] ?? null;
+    results.push({
+      name: name,
+      ns_per_op: {
+        min: samples[0],
+        p50: p50,
+        p90: percentile(samples, 0.9),
+        p99: percentile(samples, 0.99),
+      },
+      c_p50: cP50,
+      overhead: cP50 ? Math.round((p50 / cP50) * 10) / 10 : null,
+    });
+  }
+
+  print(
+    "benchmark".padEnd(24) + "gjs ns/op".padStart(14) +
+      "C ns/op".padStart(10) + "ratio".padStart(9),
+  );
+  for (let r of [...results].sort((a, b) => (b.overhead ?? 0) - (a.overhead ?? 0))) {
+    print(
+      r.name.padEnd(24) + r.ns_per_op.p50.toFixed(1).padStart(14) +
+        (r.c_p50 ? r.c_p50.toFixed(1) : "-").padStart(10) +
+        (r.overhead ? `${r.overhead.toFixed(1)}x` : "-").padStart(9),
+    );
+  }
+
+  if (outputPath) {
+    let json = JSON.stringify({
+      library: "myobject",
+      binding: "gjs",
+      samples: BENCH_SAMPLES,
+      benchmarks: results,
+    }, null, 2);
+    GLib.file_set_contents(outputPath, json);
+  }
 }
 
 /**
  * Main demonstration function
  */
 function main() {
+  // gjs example.js --bench [C_RESULTS_JSON [OUTPUT_JSON]]
+  let benchIndex = ARGV.indexOf("--bench");
+  if (benchIndex >= 0) {
+    let args = ARGV.slice(benchIndex + 1);
+    runBenchmarks(args[0] ?? "build/bench.json", args[1] ?? null);
+    return;
+  }
+
   print("🚀 JavaScript GObject Introspection Demo for MyObject");
   print("This demonstrates how to use C GObjects from JavaScript using GJS\n");
 
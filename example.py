@@ -8,6 +8,8 @@ GObject Introspection bindings.
 
 import sys
 import os
+import json
+import time
 
 # Add the build directory to the path for our GIR files
 build_path = os.path.join(os.path.dirname(__file__), 'build')
@@ -72,6 +74,10 @@ def demonstrate_basic_usage():
     obj2.increment()
     obj2.increment()
 
+    # Apply a larger delta in one call
+    old_value = obj1.fetch_add(10)
+    print(f"obj1 went from {old_value} to {obj1.get_value()}")
+
     # Display string representations
     print(f"\nObject 1: {obj1.to_string()}")
     print(f"Object 2: {obj2.to_string()}")
@@ -194,14 +200,11 @@ def stress_test():
     print("STRESS TEST")
     print("=" * 50)
 
-    objects = []
     num_objects = 1000
 
-    print(f"Creating {num_objects} objects...")
-    for i in range(num_objects):
-        obj = My.Object.new_with_value(i)
-        obj.set_name(f"Object #{i}")
-        objects.append(obj)
+    print(f"Creating {num_objects} objects in one call...")
+    objects = My.Object.new_many(list(range(num_objects)),
+                                 [f"Object #{i}" for i in range(num_objects)])
 
     print(f"Created {len(objects)} objects")
 
@@ -213,14 +216,175 @@ def stress_test():
 
     print(f"Total value across all objects: {total_value}")
 
+    # The same computation over a contiguous value column
+    print("Repeating with My.ObjectArray...")
+    array = My.ObjectArray.new_from_values(list(range(num_objects)))
+    array.increment_all()
+    print(f"Total value from ObjectArray.sum(): {array.sum()}")
+
     print("Cleaning up...")
     objects.clear()  # This should trigger garbage collection
 
     print("Stress test completed successfully!")
 
 
+# Benchmark mode: the same operation mix as bench.c, timed through PyGI
+BENCH_SAMPLES = 21
+BENCH_BATCH = 2000
+BENCH_MANY_HANDLERS = 8
+
+
+def _bench_object():
+    obj = My.Object.new_with_value(1)
+    obj.set_name("benchmark")
+    return obj
+
+
+def _bench_object_with_handlers(n_handlers):
+    obj = _bench_object()
+    for _ in range(n_handlers):
+        obj.connect("value-changed", lambda o, v: None)
+    return obj
+
+
+def _run_new(obj, n):
+    for _ in range(n):
+        My.Object.new()
+
+
+def _run_new_with_value(obj, n):
+    for i in range(n):
+        My.Object.new_with_value(i)
+
+
+def _run_get_value(obj, n):
+    for _ in range(n):
+        obj.get_value()
+
+
+def _run_set_value(obj, n):
+    base = obj.get_value()
+    for i in range(n):
+        obj.set_value(base + i + 1)
+
+
+def _run_set_name(obj, n):
+    names = ("short-a", "short-b",
+             "a name that is too long to be stored inline",
+             "another name that is too long to be stored inline")
+    for i in range(n):
+        obj.set_name(names[i % len(names)])
+
+
+def _run_to_string(obj, n):
+    for _ in range(n):
+        obj.to_string()
+
+
+def _run_property_get(obj, n):
+    for _ in range(n):
+        obj.get_property("value")
+
+
+def _run_property_set(obj, n):
+    base = obj.get_value()
+    for i in range(n):
+        obj.set_property("value", base + i + 1)
+
+
+def _run_batch_increment(obj, n):
+    obj.begin_update()
+    for _ in range(n):
+        obj.increment()
+    obj.end_update()
+
+
+# Names match the entries in bench.c so results can be joined by name
+BENCH_CASES = (
+    ("new", lambda: None, _run_new),
+    ("new_with_value", lambda: None, _run_new_with_value),
+    ("get_value", _bench_object, _run_get_value),
+    ("set_value", _bench_object, _run_set_value),
+    ("set_value_1_handler",
+     lambda: _bench_object_with_handlers(1), _run_set_value),
+    ("set_value_8_handlers",
+     lambda: _bench_object_with_handlers(BENCH_MANY_HANDLERS), _run_set_value),
+    ("set_name", _bench_object, _run_set_name),
+    ("to_string", _bench_object, _run_to_string),
+    ("property_get", _bench_object, _run_property_get),
+    ("property_set", _bench_object, _run_property_set),
+    ("batch_increment", _bench_object, _run_batch_increment),
+)
+
+
+def _percentile(sorted_samples, p):
+    rank = int(p * (len(sorted_samples) - 1) + 0.5)
+    return sorted_samples[min(rank, len(sorted_samples) - 1)]
+
+
+def _load_c_results(path):
+    """Return {name: p50 ns/op} from a bench.c JSON file, or {}."""
+    try:
+        with open(path) as f:
+            data = json.load(f)
+    except (OSError, ValueError):
+        return {}
+    return {b["name"]: b["ns_per_op"]["p50"] for b in data["benchmarks"]}
+
+
+def run_benchmarks(c_results_path, output_path=None):
+    """Time each API through PyGI and compare against the C harness."""
+    c_results = _load_c_results(c_results_path)
+    results = []
+
+    for name, setup, run in BENCH_CASES:
+        obj = setup()
+        run(obj, BENCH_BATCH)  # warm-up
+
+        samples = []
+        for _ in range(BENCH_SAMPLES):
+            start = time.perf_counter_ns()
+            run(obj, BENCH_BATCH)
+            samples.append((time.perf_counter_ns() - start) / BENCH_BATCH)
+        samples.sort()
+
+        p50 = _percentile(samples, 0.50)
+        c_p50 = c_results.get(name)
+        results.append({
+            "name": name,
+            "ns_per_op": {
+                "min": round(samples[0], 2),
+                "p50": round(p50, 2),
+                "p90": round(_percentile(samples, 0.90), 2),
+                "p99": round(_percentile(samples, 0.99), 2),
+            },
+            "c_p50": c_p50,
+            "overhead": round(p50 / c_p50, 1) if c_p50 else None,
+        })
+
+    print(f"{'benchmark':<24}{'python ns/op':>14}{'C ns/op':>10}{'ratio':>9}")
+    for r in sorted(results, key=lambda r: -(r["overhead"] or 0)):
+        c_p50 = f"{r['c_p50']:.1f}" if r["c_p50"] else "-"
+        ratio = f"{r['overhead']:.1f}x" if r["overhead"] else "-"
+        print(f"{r['name']:<24}{r['ns_per_op']['p50']:>14.1f}"
+              f"{c_p50:>10}{ratio:>9}")
+
+    if output_path:
+        with open(output_path, "w") as f:
+            json.dump({"library": "myobject", "binding": "pygobject",
+                       "samples": BENCH_SAMPLES, "benchmarks": results},
+                      f, indent=2)
+
+
 def main():
     """Main demonstration function."""
+    if "--bench" in sys.argv:
+        # example.py --bench [C_RESULTS_JSON [OUTPUT_JSON]]
+        args = sys.argv[sys.argv.index("--bench") + 1:]
+        c_results = args[0] if args else os.path.join(build_path, "bench.json")
+        run_benchmarks(c_results, args[1] if len(args) > 1 else None)
+        return
+
     print("🐍 Python GObject Introspection Demo for MyObject")
     print("This demonstrates how to use C GObjects from Python\n")
 
@@ -0,0 +1,119 @@
+#include "memcount.h"
+#include <stddef.h>
+
+#if defined(__GLIBC__)
+
+/* The C library's own entry points, which the wrappers forward to */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t n, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void __libc_free (void *ptr);
+
+static gint counting = 0;
+static guint64 n_allocations = 0;
+static guint64 n_bytes = 0;
+
+static inline void
+memcount_record (size_t size)
+{
+    if (__atomic_load_n (&counting, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add (&n_allocations, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add (&n_bytes, size, __ATOMIC_RELAXED);
+    }
+}
+
+void *
+malloc (size_t size)
+{
+    memcount_record (size);
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t n, size_t size)
+{
+    memcount_record (n * size);
+    return __libc_calloc (n, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+    memcount_record (size);
+    return __libc_realloc (ptr, size);
+}
+
+int
+posix_memalign (void **ptr, size_t alignment, size_t size)
+{
+    void *mem;
+    
+    memcount_record (size);
+    mem = __libc_memalign (alignment, size);
+    if (mem == NULL)
+        return 12; /* ENOMEM */
+    
+    *ptr = mem;
+    return 0;
+}
+
+void
+free (void *ptr)
+{
+    __libc_free (ptr);
+}
+
+gboolean
+memcount_available (void)
+{
+    return TRUE;
+}
+
+void
+memcount_begin (void)
+{
+    __atomic_store_n (&n_allocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n (&n_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n (&counting, 1, __ATOMIC_RELAXED);
+}
+
+guint64
+memcount_end (void)
+{
+    __atomic_store_n (&counting, 0, __ATOMIC_RELAXED);
+    return __atomic_load_n (&n_allocations, __ATOMIC_RELAXED);
+}
+
+guint64
+memcount_get_bytes (void)
+{
+    return __atomic_load_n (&n_bytes, __ATOMIC_RELAXED);
+}
+
+#else /* !__GLIBC__ */
+
+gboolean
+memcount_available (void)
+{
+    return FALSE;
+}
+
+void
+memcount_begin (void)
+{
+}
+
+guint64
+memcount_end (void)
+{
+    return 0;
+}
+
+guint64
+memcount_get_bytes (void)
+{
+    return 0;
+}
+
+#endif /* __GLIBC__ */
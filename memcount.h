@@ -0,0 +1,25 @@
+#ifndef MEMCOUNT_H
+#define MEMCOUNT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Heap allocation counter for the benchmark and test programs.
+ *
+ * Linking memcount.c into a program replaces malloc() and friends with
+ * wrappers that forward to the C library and count calls made between
+ * memcount_begin() and memcount_end(), along with the bytes they request
+ * (memcount_get_bytes()). Only glibc is supported; on other C libraries
+ * memcount_available() returns FALSE and nothing is counted.
+ */
+
+gboolean memcount_available (void);
+void memcount_begin (void);
+guint64 memcount_end (void);
+guint64 memcount_get_bytes (void);
+
+G_END_DECLS
+
+#endif /* MEMCOUNT_H */
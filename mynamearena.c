@@ -0,0 +1,53 @@
+#include "myobject-private.h"
+
+/*
+ * MyNameArena: a reference-counted GStringChunk used to store object
+ * names without one heap allocation per name. Strings are deduplicated
+ * and only released when the last reference to the arena goes away.
+ */
+
+struct _MyNameArena {
+    gint ref_count;
+    GStringChunk *chunk;
+};
+
+MyNameArena *
+my_name_arena_new (gsize block_size)
+{
+    MyNameArena *arena = g_new (MyNameArena, 1);
+    
+    arena->ref_count = 1;
+    arena->chunk = g_string_chunk_new (block_size);
+    
+    return arena;
+}
+
+MyNameArena *
+my_name_arena_ref (MyNameArena *arena)
+{
+    g_return_val_if_fail (arena != NULL, NULL);
+    
+    g_atomic_int_inc (&arena->ref_count);
+    
+    return arena;
+}
+
+void
+my_name_arena_unref (MyNameArena *arena)
+{
+    g_return_if_fail (arena != NULL);
+    
+    if (g_atomic_int_dec_and_test (&arena->ref_count)) {
+        g_string_chunk_free (arena->chunk);
+        g_free (arena);
+    }
+}
+
+const gchar *
+my_name_arena_insert (MyNameArena *arena, const gchar *name)
+{
+    g_return_val_if_fail (arena != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+    
+    return g_string_chunk_insert_const (arena->chunk, name);
+}
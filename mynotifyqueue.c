@@ -0,0 +1,136 @@
+#include "myobject-private.h"
+
+/*
+ * MyNotifyQueue: delivers deferred value changes on a GMainContext.
+ *
+ * There is one queue per context, a GSource attached to it. Producers on
+ * any thread push objects onto a lock-free intrusive stack; only the push
+ * that finds the stack empty touches the context, to make the source
+ * ready. The dispatch takes the whole stack with one exchange, so pushes
+ * never contend with pops and the stack is free of ABA problems, then
+ * delivers the objects in the order they were queued.
+ *
+ * The context owns the source. When the context is finalized the source
+ * removes itself from the table of queues; objects hold a reference on
+ * their context, so that only happens once no object can push to it.
+ */
+
+struct _MyNotifyQueue {
+    GSource source;
+    GMainContext *context;  /* not a reference, the context owns us */
+    MyNotifyLink *head;
+};
+
+static GMutex queues_lock;
+static GHashTable *queues = NULL;
+
+static gboolean
+my_notify_queue_dispatch (GSource    *source,
+                          GSourceFunc callback,
+                          gpointer    user_data)
+{
+    MyNotifyQueue *queue = (MyNotifyQueue *) source;
+    MyNotifyLink *head, *ordered = NULL;
+    
+    /* Disarm before taking the stack, so a push racing with this
+     * dispatch either lands in the taken stack or re-arms the source */
+    g_source_set_ready_time (source, -1);
+    
+    do {
+        head = g_atomic_pointer_get (&queue->head);
+    } while (!g_atomic_pointer_compare_and_exchange (&queue->head, head, NULL));
+    
+    /* The stack is newest first */
+    while (head) {
+        MyNotifyLink *next = head->next;
+        
+        head->next = ordered;
+        ordered = head;
+        head = next;
+    }
+    
+    while (ordered) {
+        MyNotifyLink *next = ordered->next;
+        
+        my_object_deliver_deferred (ordered->object);
+        ordered = next;
+    }
+    
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+my_notify_queue_finalize (GSource *source)
+{
+    MyNotifyQueue *queue = (MyNotifyQueue *) source;
+    MyNotifyLink *link = queue->head;
+    
+    g_mutex_lock (&queues_lock);
+    if (g_hash_table_lookup (queues, queue->context) == queue)
+        g_hash_table_remove (queues, queue->context);
+    g_mutex_unlock (&queues_lock);
+    
+    /* Objects that moved to another context may still be linked here */
+    while (link) {
+        MyNotifyLink *next = link->next;
+        
+        my_object_drop_deferred (link->object);
+        link = next;
+    }
+}
+
+static GSourceFuncs my_notify_queue_funcs = {
+    NULL,
+    NULL,
+    my_notify_queue_dispatch,
+    my_notify_queue_finalize,
+    NULL,
+    NULL
+};
+
+MyNotifyQueue *
+my_notify_queue_get (GMainContext *context)
+{
+    MyNotifyQueue *queue;
+    
+    g_return_val_if_fail (context != NULL, NULL);
+    
+    g_mutex_lock (&queues_lock);
+    
+    if (!queues)
+        queues = g_hash_table_new (g_direct_hash, g_direct_equal);
+    
+    queue = g_hash_table_lookup (queues, context);
+    if (!queue) {
+        GSource *source = g_source_new (&my_notify_queue_funcs, sizeof (MyNotifyQueue));
+        
+        g_source_set_priority (source, G_PRIORITY_DEFAULT);
+        g_source_set_ready_time (source, -1);
+        g_source_set_name (source, "MyObject notify queue");
+        g_source_attach (source, context);
+        g_source_unref (source);
+        
+        queue = (MyNotifyQueue *) source;
+        queue->context = context;
+        g_hash_table_insert (queues, context, queue);
+    }
+    
+    g_mutex_unlock (&queues_lock);
+    
+    return queue;
+}
+
+void
+my_notify_queue_push (MyNotifyQueue *queue, MyNotifyLink *link)
+{
+    MyNotifyLink *head;
+    
+    do {
+        head = g_atomic_pointer_get (&queue->head);
+        link->next = head;
+    } while (!g_atomic_pointer_compare_and_exchange (&queue->head, head, link));
+    
+    /* Only the first push of a wave needs to wake the context */
+    if (head == NULL)
+        g_source_set_ready_time (&queue->source, 0);
+}
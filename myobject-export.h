@@ -0,0 +1,18 @@
+#ifndef MY_OBJECT_EXPORT_H
+#define MY_OBJECT_EXPORT_H
+
+/**
+ * MY_OBJECT_EXPORT:
+ *
+ * Marks a function as part of the public API of the library. The library
+ * is built with -fvisibility=hidden by the release-fast profile, so any
+ * function declared in a public header without this macro is not
+ * exported from the shared object.
+ */
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define MY_OBJECT_EXPORT __attribute__ ((visibility ("default"))) extern
+#else
+#define MY_OBJECT_EXPORT extern
+#endif
+
+#endif /* MY_OBJECT_EXPORT_H */
@@ -0,0 +1,91 @@
+#ifndef MY_OBJECT_INLINE_H
+#define MY_OBJECT_INLINE_H
+
+#include "myobject.h"
+
+/**
+ * SECTION:myobject-inline
+ * @short_description: Unchecked inline accessors for C callers
+ * @title: Inline accessors
+ * @stability: Unstable
+ * @include: myobject-inline.h
+ *
+ * The functions in this header read a #MyObject without calling into the
+ * library: there is no type check of the instance and no function call,
+ * so a loop over many objects compiles down to plain loads. Passing
+ * anything other than a valid #MyObject is undefined behaviour.
+ *
+ * The accessors read the private data at its fixed offset from the
+ * instance, which is known once the class is initialized, right where
+ * it meets the #GObject header. Atomic and sharded objects fall back to
+ * the out-of-line getters, which do the loads those modes need.
+ *
+ * This header is meant for C code only and is not seen by the
+ * introspection scanner; bindings keep using the checked API.
+ */
+
+#ifndef __GI_SCANNER__
+
+G_BEGIN_DECLS
+
+/*< private >
+ * _MyObjectInlineData:
+ *
+ * Mirrors the last members of the private data of #MyObject. The
+ * layout is part of the ABI and checked when the library is built.
+ */
+typedef struct {
+    gint *storage;
+    gchar *name;
+    gint value;
+    guint8 atomic;
+} _MyObjectInlineData;
+
+/* Offset of the mirrored members from the instance, set by class init */
+MY_OBJECT_EXPORT
+gint _my_object_inline_offset;
+
+static inline const _MyObjectInlineData *
+_my_object_inline_data (MyObject *self)
+{
+    return (const _MyObjectInlineData *) G_STRUCT_MEMBER_P (self, _my_object_inline_offset);
+}
+
+/**
+ * my_object_get_value_fast:
+ * @self: a #MyObject
+ *
+ * Gets the value like my_object_get_value(), without checking @self.
+ *
+ * Returns: the current value
+ */
+static inline gint
+my_object_get_value_fast (MyObject *self)
+{
+    const _MyObjectInlineData *data = _my_object_inline_data (self);
+    
+    if (G_UNLIKELY (data->atomic))
+        return my_object_get_value (self);
+    
+    return *data->storage;
+}
+
+/**
+ * my_object_get_name_fast:
+ * @self: a #MyObject
+ *
+ * Gets the name like my_object_get_name(), without checking @self.
+ *
+ * Returns: (nullable): the current name or %NULL
+ */
+static inline const gchar *
+my_object_get_name_fast (MyObject *self)
+{
+    return _my_object_inline_data (self)->name;
+}
+
+G_END_DECLS
+
+#endif /* __GI_SCANNER__ */
+
+#endif /* MY_OBJECT_INLINE_H */
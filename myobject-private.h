@@ -0,0 +1,232 @@
+#ifndef MY_OBJECT_PRIVATE_H
+#define MY_OBJECT_PRIVATE_H
+
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Internal API used by the collection types that store object values
+ * outside of the instance. Not installed and not part of the GIR.
+ */
+
+/* Called from finalize so the owner can forget the slot at @index */
+typedef void (*MyObjectDetachFunc) (GObject *owner, guint index);
+
+/* Makes @self read and write its value through @storage. The object
+ * keeps a reference on @owner until it is finalized. */
+G_GNUC_INTERNAL
+void my_object_attach_storage (MyObject          *self,
+                               gint              *storage,
+                               GObject           *owner,
+                               guint              index,
+                               MyObjectDetachFunc detach);
+
+/* Called before the name of an attached object changes, so that the
+ * owner can persist @name (which may be NULL) for the slot at @index.
+ * Returning FALSE refuses the rename and leaves the name as it was. */
+typedef gboolean (*MyObjectPersistNameFunc) (GObject     *owner,
+                                             guint        index,
+                                             const gchar *name);
+
+/* Makes an object attached with my_object_attach_storage() persist its
+ * names with the owner. The object still keeps its own copy of the name
+ * for my_object_get_name(). */
+G_GNUC_INTERNAL
+void my_object_attach_name_storage (MyObject               *self,
+                                    MyObjectPersistNameFunc persist_name);
+
+/* Points an attached object at the new address of its slot */
+G_GNUC_INTERNAL
+void my_object_relocate_storage (MyObject *self, gint *storage);
+
+/* Reports a change the owner made to the slot behind the object's back */
+G_GNUC_INTERNAL
+void my_object_storage_changed (MyObject *self);
+
+/* Reference-counted string arena for names, see mynamearena.c. Not
+ * thread-safe for insertion; the reference count is atomic. */
+typedef struct _MyNameArena MyNameArena;
+
+G_GNUC_INTERNAL
+MyNameArena *my_name_arena_new (gsize block_size);
+G_GNUC_INTERNAL
+MyNameArena *my_name_arena_ref (MyNameArena *arena);
+G_GNUC_INTERNAL
+void my_name_arena_unref (MyNameArena *arena);
+G_GNUC_INTERNAL
+const gchar *my_name_arena_insert (MyNameArena *arena, const gchar *name);
+
+/* Per-context queue of objects with deferred notifications, see
+ * mynotifyqueue.c. Pushing is lock-free and may happen on any thread. */
+typedef struct _MyNotifyQueue MyNotifyQueue;
+
+typedef struct _MyNotifyLink MyNotifyLink;
+struct _MyNotifyLink {
+    MyNotifyLink *next;
+    MyObject *object;
+};
+
+/* Returns the queue of @context, creating it on first use. The queue
+ * lives as long as the context. */
+G_GNUC_INTERNAL
+MyNotifyQueue *my_notify_queue_get (GMainContext *context);
+
+/* Queues @link, which must not already be queued */
+G_GNUC_INTERNAL
+void my_notify_queue_push (MyNotifyQueue *queue, MyNotifyLink *link);
+
+/* Called on the queue's context to deliver the change queued for @self
+ * and release the reference taken when it was queued */
+G_GNUC_INTERNAL
+void my_object_deliver_deferred (MyObject *self);
+
+/* Releases a queued delivery without running it, when its queue goes
+ * away with its context */
+G_GNUC_INTERNAL
+void my_object_drop_deferred (MyObject *self);
+
+/* Value watches of one object, see mywatchset.c. Used from the thread
+ * that delivers the object's changes only. */
+typedef struct _MyWatchSet MyWatchSet;
+
+/* Internal observer called with every reported value change, before any
+ * watch or signal handler */
+typedef void (*MyObjectValueHook) (MyObject *object, gint value, gpointer data);
+
+/* Internal observer called whenever the name changes, before notify::name */
+typedef void (*MyObjectNameHook) (MyObject *object, gpointer data);
+
+/* Creates an empty set for an object whose value is @value */
+G_GNUC_INTERNAL
+MyWatchSet *my_watch_set_new (gint value);
+G_GNUC_INTERNAL
+void my_watch_set_free (MyWatchSet *set);
+G_GNUC_INTERNAL
+guint my_watch_set_add (MyWatchSet    *set,
+                        MyWatchKind    kind,
+                        gint           threshold,
+                        MyWatchFunc    func,
+                        gpointer       user_data,
+                        GDestroyNotify destroy);
+G_GNUC_INTERNAL
+gboolean my_watch_set_remove (MyWatchSet *set, guint id);
+G_GNUC_INTERNAL
+guint my_watch_set_get_size (MyWatchSet *set);
+G_GNUC_INTERNAL
+void my_watch_set_add_hook (MyWatchSet *set, MyObjectValueHook func, gpointer data);
+G_GNUC_INTERNAL
+gboolean my_watch_set_remove_hook (MyWatchSet *set, MyObjectValueHook func, gpointer data);
+G_GNUC_INTERNAL
+void my_watch_set_add_name_hook (MyWatchSet *set, MyObjectNameHook func, gpointer data);
+G_GNUC_INTERNAL
+gboolean my_watch_set_remove_name_hook (MyWatchSet *set, MyObjectNameHook func, gpointer data);
+
+/* Drops every watch, keeping the hooks, for an object whose value is now
+ * @value */
+G_GNUC_INTERNAL
+void my_watch_set_reset (MyWatchSet *set, gint value);
+
+/* Calls the name hooks */
+G_GNUC_INTERNAL
+void my_watch_set_name_changed (MyWatchSet *set, MyObject *object);
+
+/* Fires the watches crossed by the change to @value */
+G_GNUC_INTERNAL
+void my_watch_set_update (MyWatchSet *set, MyObject *object, gint value);
+
+/* Returns the value listeners were last told about, which differs from
+ * the current one inside a batch or before a deferred delivery. Value
+ * hooks report changes relative to it. */
+G_GNUC_INTERNAL
+gint my_object_get_reported_value (MyObject *self);
+
+/* Calls @func with every value change @self reports, the way
+ * #MyObject::value-changed would, without a signal closure. Hooks are
+ * identified by @func and @data. Not to be called from a hook. */
+G_GNUC_INTERNAL
+void my_object_add_value_hook (MyObject *self, MyObjectValueHook func, gpointer data);
+G_GNUC_INTERNAL
+void my_object_remove_value_hook (MyObject *self, MyObjectValueHook func, gpointer data);
+
+/* Calls @func after every change of the name of @self, including the
+ * one a reset makes. Same rules as value hooks. */
+G_GNUC_INTERNAL
+void my_object_add_name_hook (MyObject *self, MyObjectNameHook func, gpointer data);
+G_GNUC_INTERNAL
+void my_object_remove_name_hook (MyObject *self, MyObjectNameHook func, gpointer data);
+
+/* Names shorter than this are stored inside the instance */
+#define NAME_INLINE_SIZE 16
+
+/* Makes future names of @self come from @arena instead of the heap */
+G_GNUC_INTERNAL
+void my_object_set_name_arena (MyObject *self, MyNameArena *arena);
+
+/* Points @name at the name of @self and takes a reference on what keeps
+ * it alive: the GRefString in @name_ref or the arena in @arena, either
+ * of which may be left NULL. Returns FALSE, with nothing referenced, when
+ * the name is stored inside @self and must be copied. */
+G_GNUC_INTERNAL
+gboolean my_object_share_name (MyObject     *self,
+                               const gchar **name,
+                               gchar       **name_ref,
+                               MyNameArena **arena);
+
+/* Returns a recycled object to its freshly constructed state: value 0,
+ * no name, no signal handlers or watches and synchronous delivery. The
+ * value and name hooks stay and see both changes. Must not be called
+ * inside a batch.
+ * Returns FALSE, leaving the object untouched, for views and atomic
+ * objects, which cannot be recycled. */
+G_GNUC_INTERNAL
+gboolean my_object_reset (MyObject *self);
+
+/* Writes at most @size bytes of "TYPE_NAME(name='...', value=N)" without
+ * a terminator and returns its full length; shared with MyValue */
+G_GNUC_INTERNAL
+gsize my_object_format_parts (const gchar *type_name,
+                              const gchar *name,
+                              gint         value,
+                              gchar       *buf,
+                              gsize        size);
+
+/* Record table layout shared by MyObjectTable and MyObjectStore. All
+ * fields are little-endian. The header is followed by a column of
+ * @capacity gint32 values, a column of @capacity guint32 name offsets
+ * into the heap (MY_OBJECT_TABLE_NO_NAME for no name), and, at
+ * @heap_offset, a heap of nul-terminated names of which the first
+ * @heap_size bytes are in use. */
+#define MY_OBJECT_TABLE_MAGIC "MYOT"
+#define MY_OBJECT_TABLE_VERSION 1
+#define MY_OBJECT_TABLE_NO_NAME G_MAXUINT32
+
+typedef struct {
+    gchar magic[4];
+    guint16 version;
+    guint16 header_size;
+    guint32 n_records;
+    guint32 capacity;
+    guint64 heap_offset;
+    guint64 heap_size;
+} MyObjectTableHeader;
+
+G_STATIC_ASSERT (sizeof (MyObjectTableHeader) == 32);
+
+/* Decodes and validates the header at the start of @data, so that every
+ * column and heap offset it describes lies within @size bytes and the
+ * used heap ends with a nul */
+G_GNUC_INTERNAL
+gboolean my_object_table_header_read (const guint8        *data,
+                                      gsize                size,
+                                      MyObjectTableHeader *header,
+                                      GError             **error);
+
+/* Encodes @header at the start of @data */
+G_GNUC_INTERNAL
+void my_object_table_header_write (const MyObjectTableHeader *header,
+                                   guint8                    *data);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_PRIVATE_H */
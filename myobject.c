@@ -1,6 +1,22 @@
+#if defined(MY_OBJECT_ENABLE_STATS)
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime() */
+#endif
+
 #include "myobject.h"
+#include "myobject-inline.h"
+#include "myobject-private.h"
 #include <string.h>
 
+#if defined(MY_OBJECT_ENABLE_STATS)
+#include <time.h>
+#endif
+#if defined(MY_OBJECT_ENABLE_USDT)
+#include <sys/sdt.h>
+#endif
+#if defined(MY_OBJECT_ENABLE_SYSPROF)
+#include <sysprof-capture.h>
+#endif
+
 /**
  * SECTION:myobject
  * @short_description: An example GObject implementation
@@ -13,17 +29,173 @@
  * This object is designed to work with GObject Introspection.
  */
 
-/* Private structure */
-struct _MyObjectPrivate {
+/* How the current name is stored */
+typedef enum {
+    NAME_STORAGE_NONE,      /* name is NULL */
+    NAME_STORAGE_HEAP,      /* a GRefString, shared with clones and snapshots */
+    NAME_STORAGE_ARENA,     /* lives in name_arena */
+    NAME_STORAGE_INLINE,    /* copied into name_inline */
+    NAME_STORAGE_INTERNED   /* returned by g_intern_string() */
+} NameStorage;
+
+
+/* Sharded mode, see my_object_new_sharded(). Each shard sits on its own
+ * cache line so that threads adding to different shards never share one. */
+#define SHARD_SIZE 64
+#define MAX_SHARDS 64
+
+typedef union {
+    gint value;
+    gchar padding[SHARD_SIZE];
+} MyObjectShard;
+
+/* Representation cached by my_object_peek_string(). The buffer fits the
+ * longest value for the current name, so a changed value is formatted in
+ * place and only a name change frees it. */
+typedef struct {
     gint value;
+    gchar str[];
+} MyObjectStringCache;
+
+/* Instrumentation, see my_object_get_stats(). Counters are kept per
+ * concrete type and updated with atomic additions so that atomic and
+ * sharded objects can be counted from any thread. Building without
+ * MY_OBJECT_ENABLE_STATS, MY_OBJECT_ENABLE_USDT and
+ * MY_OBJECT_ENABLE_SYSPROF turns every macro below into nothing. */
+#if defined(MY_OBJECT_ENABLE_STATS)
+typedef struct {
+    gsize n_alive;
+    gsize n_set_value;
+    gsize n_set_value_noop;
+    gsize n_signals_emitted;
+    gsize handler_time_ns;
+    gsize n_name_reallocs;
+} MyObjectTypeStats;
+
+#define STATS_ADD(self, field, n) \
+    G_STMT_START { \
+        MyObjectPrivate *stats_priv = my_object_get_instance_private (self); \
+        if (stats_priv->cold && stats_priv->cold->stats) \
+            g_atomic_pointer_add (&stats_priv->cold->stats->field, (n)); \
+    } G_STMT_END
+#define STATS_TIMER_START(start) gint64 start = my_object_stats_now_ns ()
+#define STATS_EMITTED(self, start) \
+    G_STMT_START { \
+        STATS_ADD (self, n_signals_emitted, 1); \
+        STATS_ADD (self, handler_time_ns, my_object_stats_now_ns () - (start)); \
+    } G_STMT_END
+#else
+#define STATS_ADD(self, field, n) G_STMT_START { } G_STMT_END
+#define STATS_TIMER_START(start) G_STMT_START { } G_STMT_END
+#define STATS_EMITTED(self, start) G_STMT_START { } G_STMT_END
+#endif
+
+/* Tracepoints bracketing my_object_set_value() and the emissions, as
+ * USDT probes (myobject:set_value-begin and so on) or sysprof marks */
+#if defined(MY_OBJECT_ENABLE_USDT)
+#define TRACE_BEGIN(name, self, arg) DTRACE_PROBE2 (myobject, name##__begin, self, arg)
+#define TRACE_END(name, self, arg) DTRACE_PROBE2 (myobject, name##__end, self, arg)
+#elif defined(MY_OBJECT_ENABLE_SYSPROF)
+#define TRACE_BEGIN(name, self, arg) gint64 trace_##name = SYSPROF_CAPTURE_CURRENT_TIME
+#define TRACE_END(name, self, arg) \
+    sysprof_collector_mark (trace_##name, SYSPROF_CAPTURE_CURRENT_TIME - trace_##name, \
+                            "MyObject", #name, "%p %d", (void *) (self), (int) (arg))
+#else
+#define TRACE_BEGIN(name, self, arg) G_STMT_START { } G_STMT_END
+#define TRACE_END(name, self, arg) G_STMT_START { } G_STMT_END
+#endif
+
+/* State that only views, atomic and sharded objects, batches, watches
+ * and the other less common features need. It lives in a block of its
+ * own, allocated by my_object_get_cold() on first use, so that a plain
+ * object costs no more than its hot members. */
+typedef struct {
+    MyNameArena *name_arena;
+    
+    /* The collection *storage points into, if any */
+    GObject *storage_owner;
+    MyObjectDetachFunc storage_detach;
+    MyObjectPersistNameFunc storage_persist_name;
+    
+    /* Sharded mode: the value is *storage plus the sum of the shards,
+     * which start at the first cache line boundary in shards_block */
+    gpointer shards_block;
+    
+    /* Deferred delivery, see my_object_set_notify_context() */
+    GMainContext *notify_context;
+    MyNotifyQueue *notify_queue;
+    MyNotifyLink notify_link;
+    
+    /* Created by the first my_object_add_watch() */
+    MyWatchSet *watches;
+    
+    /* Built by my_object_peek_string(), dropped when the name changes */
+    MyObjectStringCache *string_cache;
+    
+#if defined(MY_OBJECT_ENABLE_STATS)
+    /* Counters of the concrete type, set once construction is done */
+    MyObjectTypeStats *stats;
+#endif
+    
+    gchar name_inline[NAME_INLINE_SIZE];
+    GQuark name_quark;
+    guint storage_index;
+    guint shard_mask;
+    gint notify_pending;
+    gint notified_value;
+    
+    /* Batch update state, see my_object_begin_update() */
+    guint update_depth;
+    gint batch_start_value;
+} MyObjectCold;
+
+/* Private structure. GLib places it right before the instance, so it
+ * shares a cache line with the GObject header. Besides the pointer to
+ * the cold block it only holds what every accessor needs; the members
+ * from storage on are read directly by myobject-inline.h, which mirrors
+ * them as _MyObjectInlineData. */
+struct _MyObjectPrivate {
+    /* NULL until a feature that needs it is first used */
+    MyObjectCold *cold;
+    
+    /* Where the value lives: &value, or a slot owned by a collection */
+    gint *storage;
     gchar *name;
+    gint value;
+    
+    /* Atomic mode, see my_object_new_atomic() */
+    guint8 atomic;
+    
+    guint name_storage : 3;     /* NameStorage */
+    guint intern_names : 1;
+    guint name_arena_sealed : 1;    /* name_arena only holds the current name */
 };
 
+/* Footprint budget on LP64: 32 bytes of private data, which GLib does
+ * not need to pad, plus the 24-byte GObject header make a 56-byte
+ * allocation, against 48 bytes for ABI 1 with its priv pointer. Features
+ * that need more state add it to MyObjectCold, not here. */
+#if GLIB_SIZEOF_VOID_P == 8
+#define MY_OBJECT_PRIVATE_SIZE_BUDGET 32
+G_STATIC_ASSERT (sizeof (MyObjectPrivate) <= MY_OBJECT_PRIVATE_SIZE_BUDGET);
+#endif
+G_STATIC_ASSERT (sizeof (MyObject) == sizeof (GObject));
+
+#define INLINE_OFFSET(member) \
+    (G_STRUCT_OFFSET (MyObjectPrivate, member) - G_STRUCT_OFFSET (MyObjectPrivate, storage))
+G_STATIC_ASSERT (INLINE_OFFSET (storage) == G_STRUCT_OFFSET (_MyObjectInlineData, storage));
+G_STATIC_ASSERT (INLINE_OFFSET (name) == G_STRUCT_OFFSET (_MyObjectInlineData, name));
+G_STATIC_ASSERT (INLINE_OFFSET (value) == G_STRUCT_OFFSET (_MyObjectInlineData, value));
+G_STATIC_ASSERT (INLINE_OFFSET (atomic) == G_STRUCT_OFFSET (_MyObjectInlineData, atomic));
+
 /* Property enumeration */
 enum {
     PROP_0,
     PROP_VALUE,
     PROP_NAME,
+    PROP_ATOMIC,
+    PROP_INTERN_NAMES,
+    PROP_SHARDED,
     N_PROPERTIES
 };
 
@@ -35,10 +207,26 @@ enum {
 
 static GParamSpec *properties[N_PROPERTIES] = { NULL };
 static guint signals[LAST_SIGNAL] = { 0 };
+static guint notify_signal_id = 0;
+static GQuark value_quark = 0;
+
+/* Shard slot of the current thread plus one, 0 until first used */
+static GPrivate shard_slot;
+static gint next_shard_slot = 0;
+
+#if defined(MY_OBJECT_ENABLE_STATS)
+/* GType -> MyObjectTypeStats, never freed since types are static */
+static GMutex stats_lock;
+static GHashTable *stats_by_type = NULL;
+#endif
 
 /* GObject boilerplate */
 G_DEFINE_TYPE_WITH_PRIVATE (MyObject, my_object, G_TYPE_OBJECT)
 
+/* Offset of the members mirrored by myobject-inline.h */
+gint _my_object_inline_offset = 0;
+G_DEFINE_QUARK (my-object-error-quark, my_object_error)
+
 /* Forward declarations */
 static void my_object_dispose (GObject *object);
 static void my_object_finalize (GObject *object);
@@ -50,6 +238,14 @@ static void my_object_set_property (GObject *object,
                                     guint prop_id,
                                     const GValue *value,
                                     GParamSpec *pspec);
+static inline gint my_object_load_value (MyObject *self);
+static void my_object_enable_atomic (MyObject *self);
+static void my_object_enable_shards (MyObject *self);
+static void my_object_clear_name (MyObject *self);
+static MyObjectCold *my_object_get_cold (MyObject *self);
+#if defined(MY_OBJECT_ENABLE_STATS)
+static void my_object_constructed (GObject *object);
+#endif
 
 /* Class initialization */
 static void
@@ -57,10 +253,17 @@ my_object_class_init (MyObjectClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS (klass);
     
+    /* The private offset is final once class_intern_init adjusted it */
+    _my_object_inline_offset = MyObject_private_offset +
+                               G_STRUCT_OFFSET (MyObjectPrivate, storage);
+    
     object_class->dispose = my_object_dispose;
     object_class->finalize = my_object_finalize;
     object_class->get_property = my_object_get_property;
     object_class->set_property = my_object_set_property;
+#if defined(MY_OBJECT_ENABLE_STATS)
+    object_class->constructed = my_object_constructed;
+#endif
     
     /* Install properties */
     properties[PROP_VALUE] = 
@@ -79,6 +282,55 @@ my_object_class_init (MyObjectClass *klass)
                             NULL,
                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
     
+    /**
+     * MyObject:atomic:
+     *
+     * Whether the value is updated with atomic operations, allowing
+     * my_object_set_value(), my_object_increment() and
+     * my_object_decrement() to be called from several threads at once.
+     * Change notifications are then deferred to the thread-default
+     * #GMainContext of the constructing thread.
+     *
+     * Writes need no batch and work on any thread. A batch, and so a
+     * #MyObjectTransaction, can only be opened on a thread that can
+     * acquire the notify context; on others my_object_begin_update()
+     * returns %FALSE and the writes are delivered one by one.
+     */
+    properties[PROP_ATOMIC] = 
+        g_param_spec_boolean ("atomic",
+                             "Atomic",
+                             "Whether the value is updated atomically",
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    
+    /**
+     * MyObject:intern-names:
+     *
+     * Whether names passed to my_object_set_name() are interned with
+     * g_intern_string(). Setting an interned name that is already set is
+     * a pointer comparison and never allocates. Interned strings are
+     * never freed, so this suits names from a fixed vocabulary.
+     */
+    properties[PROP_INTERN_NAMES] = 
+        g_param_spec_boolean ("intern-names",
+                             "Intern names",
+                             "Whether names are stored as interned strings",
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+    
+    /**
+     * MyObject:sharded:
+     *
+     * Whether additions are spread over per-thread shards, see
+     * my_object_new_sharded(). A sharded object is also atomic.
+     */
+    properties[PROP_SHARDED] = 
+        g_param_spec_boolean ("sharded",
+                             "Sharded",
+                             "Whether additions go to per-thread shards",
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    
     g_object_class_install_properties (object_class, N_PROPERTIES, properties);
     
     /* Install signals */
@@ -87,7 +339,9 @@ my_object_class_init (MyObjectClass *klass)
      * @self: the #MyObject instance
      * @new_value: the new value
      *
-     * Emitted when the value property changes.
+     * Emitted when the value property changes. When no handler is
+     * connected and the class handler is %NULL the emission is skipped
+     * entirely, so emission hooks only see changes that have listeners.
      */
     signals[VALUE_CHANGED] = 
         g_signal_new ("value-changed",
@@ -99,15 +353,30 @@ my_object_class_init (MyObjectClass *klass)
                      G_TYPE_NONE,
                      1,
                      G_TYPE_INT);
+    
+    /* Marshal straight from the va_list, without boxing into GValues */
+    g_signal_set_va_marshaller (signals[VALUE_CHANGED],
+                                G_TYPE_FROM_CLASS (klass),
+                                g_cclosure_marshal_VOID__INTv);
+    
+    notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+    value_quark = g_quark_from_static_string ("value");
 }
 
 /* Instance initialization */
 static void
 my_object_init (MyObject *self)
 {
-    self->priv = my_object_get_instance_private (self);
-    self->priv->value = 0;
-    self->priv->name = NULL;
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    priv->cold = NULL;
+    priv->value = 0;
+    priv->storage = &priv->value;
+    priv->name = NULL;
+    priv->name_storage = NAME_STORAGE_NONE;
+    priv->intern_names = FALSE;
+    priv->name_arena_sealed = FALSE;
+    priv->atomic = FALSE;
 }
 
 /* Dispose method - release references to other objects */
@@ -125,13 +394,79 @@ static void
 my_object_finalize (GObject *object)
 {
     MyObject *self = MY_OBJECT (object);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
     
-    g_free (self->priv->name);
+    my_object_clear_name (self);
+    STATS_ADD (self, n_alive, -1);
+    
+    if (cold) {
+        g_clear_pointer (&cold->name_arena, my_name_arena_unref);
+        g_clear_pointer (&cold->notify_context, g_main_context_unref);
+        g_clear_pointer (&cold->watches, my_watch_set_free);
+        g_free (cold->shards_block);
+        
+        if (cold->storage_owner) {
+            cold->storage_detach (cold->storage_owner, cold->storage_index);
+            g_object_unref (cold->storage_owner);
+        }
+        
+        priv->cold = NULL;
+        g_free (cold);
+    }
     
     /* Chain up to parent class */
     G_OBJECT_CLASS (my_object_parent_class)->finalize (object);
 }
 
+#if defined(MY_OBJECT_ENABLE_STATS)
+static gint64
+my_object_stats_now_ns (void)
+{
+    struct timespec ts;
+    
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (gint64) ts.tv_sec * G_GINT64_CONSTANT (1000000000) + ts.tv_nsec;
+}
+
+/* Returns the counters of @type, creating them on first use */
+static MyObjectTypeStats *
+my_object_stats_for_type (GType type, gboolean create)
+{
+    MyObjectTypeStats *stats;
+    
+    g_mutex_lock (&stats_lock);
+    
+    if (!stats_by_type)
+        stats_by_type = g_hash_table_new (g_direct_hash, g_direct_equal);
+    
+    stats = g_hash_table_lookup (stats_by_type, GSIZE_TO_POINTER (type));
+    if (!stats && create) {
+        stats = g_new0 (MyObjectTypeStats, 1);
+        g_hash_table_insert (stats_by_type, GSIZE_TO_POINTER (type), stats);
+    }
+    
+    g_mutex_unlock (&stats_lock);
+    
+    return stats;
+}
+
+/* Attaches the counters of the concrete type, which instance init cannot
+ * see yet */
+static void
+my_object_constructed (GObject *object)
+{
+    MyObject *self = MY_OBJECT (object);
+    
+    G_OBJECT_CLASS (my_object_parent_class)->constructed (object);
+    
+    /* Counting builds give every object a cold block to hold this */
+    my_object_get_cold (self)->stats =
+        my_object_stats_for_type (G_OBJECT_TYPE (self), TRUE);
+    STATS_ADD (self, n_alive, 1);
+}
+#endif
+
 /* Property getter */
 static void
 my_object_get_property (GObject *object,
@@ -140,13 +475,23 @@ my_object_get_property (GObject *object,
                         GParamSpec *pspec)
 {
     MyObject *self = MY_OBJECT (object);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
     
     switch (prop_id) {
         case PROP_VALUE:
-            g_value_set_int (value, self->priv->value);
+            g_value_set_int (value, my_object_load_value (self));
             break;
         case PROP_NAME:
-            g_value_set_string (value, self->priv->name);
+            g_value_set_string (value, priv->name);
+            break;
+        case PROP_ATOMIC:
+            g_value_set_boolean (value, priv->atomic);
+            break;
+        case PROP_SHARDED:
+            g_value_set_boolean (value, priv->cold && priv->cold->shards_block);
+            break;
+        case PROP_INTERN_NAMES:
+            g_value_set_boolean (value, priv->intern_names);
             break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -170,180 +515,1690 @@ my_object_set_property (GObject *object,
         case PROP_NAME:
             my_object_set_name (self, g_value_get_string (value));
             break;
+        case PROP_ATOMIC:
+            if (g_value_get_boolean (value))
+                my_object_enable_atomic (self);
+            break;
+        case PROP_SHARDED:
+            if (g_value_get_boolean (value))
+                my_object_enable_shards (self);
+            break;
+        case PROP_INTERN_NAMES:
+            my_object_set_intern_names (self, g_value_get_boolean (value));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
     }
 }
 
-/* Public API implementation */
+/* Emits value-changed, bracketed by the instrumentation */
+static inline void
+my_object_emit_value_changed_internal (MyObject *self, gint new_value)
+{
+    STATS_TIMER_START (emit_start);
+    TRACE_BEGIN (value_changed, self, new_value);
+    g_signal_emit (self, signals[VALUE_CHANGED], 0, new_value);
+    TRACE_END (value_changed, self, new_value);
+    STATS_EMITTED (self, emit_start);
+}
 
-/**
- * my_object_new:
+/* Reports a completed value change to property and signal listeners.
  *
- * Creates a new #MyObject instance.
- *
- * Returns: (transfer full): a new #MyObject
- */
-MyObject *
-my_object_new (void)
+ * Emissions nobody can observe are skipped. GObject has no hook for
+ * handler connection, so rather than caching a flag that could go stale
+ * this asks g_signal_has_handler_pending(), a handler list lookup that
+ * costs far less than marshalling an emission. */
+static void
+my_object_value_changed_internal (MyObject *self, gint new_value)
 {
-    return g_object_new (MY_TYPE_OBJECT, NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    if (cold) {
+        cold->notified_value = new_value;
+        
+        /* Hooks and watches are plain calls, made before any closure runs */
+        if (cold->watches)
+            my_watch_set_update (cold->watches, self, new_value);
+    }
+    
+    /* Notify property change */
+    if (G_OBJECT_GET_CLASS (self)->notify != NULL ||
+        g_signal_has_handler_pending (self, notify_signal_id, value_quark, FALSE)) {
+        STATS_TIMER_START (notify_start);
+        TRACE_BEGIN (notify, self, new_value);
+        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_VALUE]);
+        TRACE_END (notify, self, new_value);
+        STATS_EMITTED (self, notify_start);
+    }
+    
+    /* Emit signal */
+    if (MY_OBJECT_GET_CLASS (self)->value_changed != NULL ||
+        g_signal_has_handler_pending (self, signals[VALUE_CHANGED], 0, FALSE))
+        my_object_emit_value_changed_internal (self, new_value);
 }
 
-/**
- * my_object_new_with_value:
- * @initial_value: the initial value to set
- *
- * Creates a new #MyObject instance with the specified initial value.
- *
- * Returns: (transfer full): a new #MyObject
- */
-MyObject *
-my_object_new_with_value (gint initial_value)
+/* Returns the cold block, allocating it on first use. Atomic and sharded
+ * objects and views get theirs during construction, before other threads
+ * can see them; other objects are only used from one thread at a time. */
+static MyObjectCold *
+my_object_get_cold (MyObject *self)
 {
-    return g_object_new (MY_TYPE_OBJECT, "value", initial_value, NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    if (G_UNLIKELY (priv->cold == NULL)) {
+        priv->cold = g_new0 (MyObjectCold, 1);
+        priv->cold->notify_link.object = self;
+        priv->cold->notified_value = *priv->storage;
+    }
+    
+    return priv->cold;
 }
 
-/**
- * my_object_set_value:
- * @self: a #MyObject
- * @value: the new value to set
- *
- * Sets the value property of the object.
- */
-void
-my_object_set_value (MyObject *self, gint value)
+/* Switches to atomic mode with deferred delivery; construction only */
+static void
+my_object_enable_atomic (MyObject *self)
 {
-    g_return_if_fail (MY_IS_OBJECT (self));
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold;
     
-    if (self->priv->value != value) {
-        gint old_value = self->priv->value;
-        self->priv->value = value;
-        
-        /* Notify property change */
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_VALUE]);
-        
-        /* Emit signal */
-        g_signal_emit (self, signals[VALUE_CHANGED], 0, value);
+    if (priv->atomic)
+        return;
+    
+    cold = my_object_get_cold (self);
+    priv->atomic = TRUE;
+    cold->notify_context = g_main_context_ref_thread_default ();
+    cold->notify_queue = my_notify_queue_get (cold->notify_context);
+}
+
+/* The shards start at the first cache line boundary of their block */
+static inline MyObjectShard *
+my_object_get_shards (MyObjectCold *cold)
+{
+    return (MyObjectShard *)
+        (((guintptr) cold->shards_block + SHARD_SIZE - 1) & ~(guintptr) (SHARD_SIZE - 1));
+}
+
+/* Allocates one cache-line-aligned shard per processor, rounded up to a
+ * power of two; construction only */
+static void
+my_object_enable_shards (MyObject *self)
+{
+    MyObjectCold *cold = my_object_get_cold (self);
+    guint n_shards = 1;
+    
+    if (cold->shards_block)
+        return;
+    
+    while (n_shards < MIN ((guint) g_get_num_processors (), MAX_SHARDS))
+        n_shards *= 2;
+    
+    my_object_enable_atomic (self);
+    
+    cold->shards_block = g_malloc0 (n_shards * SHARD_SIZE + SHARD_SIZE - 1);
+    cold->shard_mask = n_shards - 1;
+}
+
+/* Returns the shard the calling thread adds to. Threads are numbered in
+ * the order they first touch any sharded object. */
+static inline MyObjectShard *
+my_object_thread_shard (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    guint slot = GPOINTER_TO_UINT (g_private_get (&shard_slot));
+    
+    if (G_UNLIKELY (slot == 0)) {
+        slot = (guint) g_atomic_int_add (&next_shard_slot, 1) + 1;
+        g_private_set (&shard_slot, GUINT_TO_POINTER (slot));
     }
+    
+    return &my_object_get_shards (priv->cold)[(slot - 1) & priv->cold->shard_mask];
 }
 
-/**
- * my_object_get_value:
- * @self: a #MyObject
- *
- * Gets the current value of the object.
- *
- * Returns: the current value
- */
-gint
-my_object_get_value (MyObject *self)
+/* Sums the base value and every shard, wrapping like the additions did.
+ * Shards are read one after the other, so additions made during the
+ * fold may or may not be included. */
+static gint
+my_object_fold_shards (MyObject *self)
 {
-    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectShard *shards = my_object_get_shards (priv->cold);
+    guint sum = (guint) g_atomic_int_get (priv->storage);
     
-    return self->priv->value;
+    for (guint i = 0; i <= priv->cold->shard_mask; i++)
+        sum += (guint) g_atomic_int_get (&shards[i].value);
+    
+    return (gint) sum;
 }
 
-/**
- * my_object_set_name:
- * @self: a #MyObject
- * @name: (nullable): the new name to set
- *
- * Sets the name property of the object.
- */
-void
-my_object_set_name (MyObject *self, const gchar *name)
+/* Reads the value, with an atomic load in atomic mode. Sharded objects
+ * are atomic too, so plain objects never look at the cold block. */
+static inline gint
+my_object_load_value (MyObject *self)
 {
-    g_return_if_fail (MY_IS_OBJECT (self));
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
     
-    if (g_strcmp0 (self->priv->name, name) != 0) {
-        g_free (self->priv->name);
-        self->priv->name = g_strdup (name);
+    if (G_UNLIKELY (priv->atomic)) {
+        if (priv->cold->shards_block)
+            return my_object_fold_shards (self);
         
-        /* Notify property change */
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_NAME]);
+        return g_atomic_int_get (priv->storage);
     }
+    
+    return *priv->storage;
 }
 
-/**
- * my_object_get_name:
- * @self: a #MyObject
- *
- * Gets the current name of the object.
- *
- * Returns: (nullable): the current name or %NULL
- */
-const gchar *
-my_object_get_name (MyObject *self)
+/* Queues change delivery on the notify context, at most once until it
+ * runs. The queued link holds a reference on the object. */
+static void
+my_object_schedule_notify (MyObject *self)
 {
-    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    /* A plain load first keeps the flag's cache line shared between
+     * writers while a delivery is pending */
+    if (g_atomic_int_get (&cold->notify_pending) ||
+        !g_atomic_int_compare_and_exchange (&cold->notify_pending,
+                                            FALSE, TRUE))
+        return;
     
-    return self->priv->name;
+    g_object_ref (self);
+    my_notify_queue_push (cold->notify_queue, &cold->notify_link);
 }
 
-/**
- * my_object_increment:
- * @self: a #MyObject
- *
- * Increments the value by 1.
- */
-void
-my_object_increment (MyObject *self)
+/* Reports a change made outside a batch, synchronously or by queueing it
+ * for the notify context */
+static inline void
+my_object_report_change (MyObject *self, gint value)
 {
-    g_return_if_fail (MY_IS_OBJECT (self));
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
     
-    my_object_set_value (self, self->priv->value + 1);
+    if (priv->cold && priv->cold->notify_queue)
+        my_object_schedule_notify (self);
+    else
+        my_object_value_changed_internal (self, value);
 }
 
-/**
- * my_object_decrement:
- * @self: a #MyObject
- *
- * Decrements the value by 1.
- */
-void
-my_object_decrement (MyObject *self)
+/* Stores a new value and reports the change; set_value without the checks */
+static void
+my_object_store_value (MyObject *self, gint value)
 {
-    g_return_if_fail (MY_IS_OBJECT (self));
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    /* Add the difference, so that concurrent additions are not lost */
+    if (priv->atomic && cold->shards_block) {
+        gint current = my_object_fold_shards (self);
+        
+        if (current != value) {
+            g_atomic_int_add (&my_object_thread_shard (self)->value,
+                              (gint) ((guint) value - (guint) current));
+            my_object_schedule_notify (self);
+        }
+        return;
+    }
     
-    my_object_set_value (self, self->priv->value - 1);
+    if (priv->atomic) {
+        gint old_value;
+        
+        do {
+            old_value = g_atomic_int_get (priv->storage);
+        } while (!g_atomic_int_compare_and_exchange (priv->storage,
+                                                     old_value, value));
+        
+        if (old_value != value)
+            my_object_schedule_notify (self);
+        return;
+    }
+    
+    if (*priv->storage != value) {
+        /* The notify context may read the value from another thread */
+        if (cold && cold->notify_queue)
+            g_atomic_int_set (priv->storage, value);
+        else
+            *priv->storage = value;
+        
+        /* Inside a batch the change is reported by my_object_end_update() */
+        if (!cold || cold->update_depth == 0)
+            my_object_report_change (self, value);
+    }
 }
 
-/**
- * my_object_to_string:
- * @self: a #MyObject
- *
- * Creates a string representation of the object.
- *
- * Returns: (transfer full): a newly allocated string representation
- */
-gchar *
-my_object_to_string (MyObject *self)
+/* Adds @delta with wrap-around and returns the previous value */
+static gint
+my_object_fetch_add_internal (MyObject *self, gint delta)
 {
-    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    gint old_value;
     
-    if (self->priv->name) {
-        return g_strdup_printf ("MyObject(name='%s', value=%d)",
-                               self->priv->name,
-                               self->priv->value);
-    } else {
-        return g_strdup_printf ("MyObject(value=%d)", self->priv->value);
+    if (priv->atomic && priv->cold->shards_block) {
+        old_value = my_object_fold_shards (self);
+        if (delta != 0) {
+            g_atomic_int_add (&my_object_thread_shard (self)->value, delta);
+            my_object_schedule_notify (self);
+        }
+        return old_value;
+    }
+    
+    if (priv->atomic) {
+        old_value = g_atomic_int_add (priv->storage, delta);
+        if (delta != 0)
+            my_object_schedule_notify (self);
+        return old_value;
     }
+    
+    old_value = *priv->storage;
+    my_object_store_value (self, (gint) ((guint) old_value + (guint) delta));
+    
+    return old_value;
 }
 
-/**
- * my_object_emit_value_changed:
- * @self: a #MyObject
- * @new_value: the new value
- *
- * Explicitly emits the value-changed signal.
- * This is typically called internally when the value changes.
- */
-void
-my_object_emit_value_changed (MyObject *self, gint new_value)
+/* Adds @delta with wrap-around when the previous value is not needed,
+ * which spares sharded objects a fold */
+static inline void
+my_object_add_internal (MyObject *self, gint delta)
 {
-    g_return_if_fail (MY_IS_OBJECT (self));
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
     
-    g_signal_emit (self, signals[VALUE_CHANGED], 0, new_value);
-}
\ No newline at end of file
+    if (priv->atomic && priv->cold->shards_block) {
+        if (delta != 0) {
+            g_atomic_int_add (&my_object_thread_shard (self)->value, delta);
+            my_object_schedule_notify (self);
+        }
+        return;
+    }
+    
+    my_object_fetch_add_internal (self, delta);
+}
+
+/* Releases the current name according to how it is stored */
+static void
+my_object_clear_name (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    if (priv->name_storage == NAME_STORAGE_HEAP)
+        g_ref_string_release (priv->name);
+    
+    priv->name = NULL;
+    priv->name_storage = NAME_STORAGE_NONE;
+    
+    if (priv->cold) {
+        priv->cold->name_quark = 0;
+        g_clear_pointer (&priv->cold->string_cache, g_free);
+    }
+}
+
+/* Replaces the current name with @name, which may point into the
+ * current name, choosing the cheapest storage that applies. Short names
+ * are copied inline only into an existing cold block; allocating one
+ * just for that would cost more than a heap copy. */
+static void
+my_object_store_name (MyObject *self, const gchar *name)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    NameStorage storage;
+    gchar *copy = NULL;
+    gsize len = 0;
+    
+    if (name == NULL)
+        storage = NAME_STORAGE_NONE;
+    else if (priv->intern_names)
+        storage = NAME_STORAGE_INTERNED;
+    else if ((len = strlen (name)) < NAME_INLINE_SIZE && priv->cold)
+        storage = NAME_STORAGE_INLINE;
+    else if (priv->cold && priv->cold->name_arena && !priv->name_arena_sealed)
+        storage = NAME_STORAGE_ARENA;
+    else
+        storage = NAME_STORAGE_HEAP;
+    
+    /* Copy before releasing the old name, which @name may alias */
+    switch (storage) {
+        case NAME_STORAGE_INTERNED:
+            copy = (gchar *) g_intern_string (name);
+            break;
+        case NAME_STORAGE_ARENA:
+            copy = (gchar *) my_name_arena_insert (priv->cold->name_arena, name);
+            break;
+        case NAME_STORAGE_HEAP:
+            copy = g_ref_string_new_len (name, (gssize) len);
+            STATS_ADD (self, n_name_reallocs, 1);
+            break;
+        case NAME_STORAGE_INLINE:
+        case NAME_STORAGE_NONE:
+            break;
+    }
+    
+    my_object_clear_name (self);
+    
+    if (storage == NAME_STORAGE_INLINE) {
+        memmove (priv->cold->name_inline, name, len + 1);
+        copy = priv->cold->name_inline;
+    }
+    
+    priv->name = copy;
+    priv->name_storage = storage;
+}
+
+/* Longest decimal representation of a gint, "-2147483648" */
+#define INT_FORMAT_SIZE 11
+
+/* Writes @value in decimal without a terminator and returns the length */
+static gsize
+format_int (gchar *out, gint value)
+{
+    gchar digits[INT_FORMAT_SIZE];
+    guint magnitude = value < 0 ? 0u - (guint) value : (guint) value;
+    gsize n = 0;
+    gsize len = 0;
+    
+    do {
+        digits[n++] = (gchar) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    
+    if (value < 0)
+        out[len++] = '-';
+    while (n > 0)
+        out[len++] = digits[--n];
+    
+    return len;
+}
+
+/* Copies the part of @src that fits below @size and returns the new end */
+static gsize
+format_put (gchar *buf, gsize size, gsize pos, const gchar *src, gsize n)
+{
+    if (pos < size)
+        memcpy (buf + pos, src, MIN (n, size - pos));
+    
+    return pos + n;
+}
+
+gsize
+my_object_format_parts (const gchar *type_name,
+                        const gchar *name,
+                        gint         value,
+                        gchar       *buf,
+                        gsize        size)
+{
+    gchar digits[INT_FORMAT_SIZE];
+    gsize pos = 0;
+    
+    pos = format_put (buf, size, pos, type_name, strlen (type_name));
+    pos = format_put (buf, size, pos, "(", 1);
+    if (name) {
+        pos = format_put (buf, size, pos, "name='", 6);
+        pos = format_put (buf, size, pos, name, strlen (name));
+        pos = format_put (buf, size, pos, "', ", 3);
+    }
+    pos = format_put (buf, size, pos, "value=", 6);
+    pos = format_put (buf, size, pos, digits, format_int (digits, value));
+    pos = format_put (buf, size, pos, ")", 1);
+    
+    return pos;
+}
+
+/* Lets the storage owner persist @name before it replaces the current
+ * name. Returns FALSE if the owner refused it. */
+static gboolean
+my_object_persist_name (MyObject *self, const gchar *name)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    if (cold == NULL || cold->storage_persist_name == NULL)
+        return TRUE;
+    
+    return cold->storage_persist_name (cold->storage_owner,
+                                       cold->storage_index,
+                                       name);
+}
+
+/* Tells internal hooks and listeners about a new name */
+static void
+my_object_name_changed (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    if (cold && cold->watches)
+        my_watch_set_name_changed (cold->watches, self);
+    
+    /* Notify property change */
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_NAME]);
+}
+
+/* Serialized record, all fields little-endian:
+ *
+ *   guint8  version       MY_OBJECT_RECORD_VERSION
+ *   guint8  flags         RECORD_FLAG_*
+ *   gint32  value
+ *   guint32 name_length   0 when there is no name
+ *   gchar   name[name_length], not nul-terminated
+ */
+#define MY_OBJECT_RECORD_VERSION 1
+#define RECORD_HEADER_SIZE 10
+#define RECORD_FLAG_HAS_NAME (1 << 0)
+
+/* Public API implementation */
+
+/**
+ * my_object_new:
+ *
+ * Creates a new #MyObject instance.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_new (void)
+{
+    return g_object_new (MY_TYPE_OBJECT, NULL);
+}
+
+/**
+ * my_object_new_with_value:
+ * @initial_value: the initial value to set
+ *
+ * Creates a new #MyObject instance with the specified initial value.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_new_with_value (gint initial_value)
+{
+    return my_object_new_full (initial_value, NULL);
+}
+
+/**
+ * my_object_new_full:
+ * @initial_value: the initial value to set
+ * @name: (nullable): the initial name
+ *
+ * Creates a new #MyObject instance with the specified initial value and
+ * name. The fields are written directly after the instance is created,
+ * without going through the property machinery or emitting any
+ * notification, so this is the cheapest way to construct a named object.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_new_full (gint initial_value, const gchar *name)
+{
+    MyObject *self = g_object_new (MY_TYPE_OBJECT, NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    /* A fresh plain object stores its value in place. A cold block made
+     * during construction took 0 as the value listeners last saw. */
+    priv->value = initial_value;
+    if (priv->cold)
+        priv->cold->notified_value = initial_value;
+    if (name)
+        my_object_store_name (self, name);
+    
+    return self;
+}
+
+/**
+ * my_object_new_many:
+ * @values: (array length=n_values): the initial values
+ * @names: (array length=n_values) (nullable): the initial names, or %NULL
+ *   for unnamed objects
+ * @n_values: the number of objects to create
+ *
+ * Creates @n_values objects at once, the same as calling
+ * my_object_new_full() with each value and name, in a single call that
+ * bindings can make for a whole dataset. Individual names may be %NULL.
+ *
+ * Names too long to be stored inline are copied into one block shared by
+ * the new objects rather than allocated one by one. Names set later are
+ * stored as usual; the block is freed with the last object that was
+ * created with a name from it.
+ *
+ * Returns: (transfer full) (element-type MyObject): the new objects, in
+ *   the order of @values
+ */
+GPtrArray *
+my_object_new_many (const gint          *values,
+                    const gchar * const *names,
+                    guint                n_values)
+{
+    GPtrArray *objects;
+    MyNameArena *arena = NULL;
+    gsize arena_size = 0;
+    guint i;
+    
+    g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+    
+    /* Size the block for exactly the names that will not fit inline */
+    for (i = 0; names && i < n_values; i++) {
+        gsize len = names[i] ? strlen (names[i]) : 0;
+        
+        if (len >= NAME_INLINE_SIZE)
+            arena_size += len + 1;
+    }
+    if (arena_size > 0)
+        arena = my_name_arena_new (arena_size);
+    
+    objects = g_ptr_array_new_full (n_values, g_object_unref);
+    
+    for (i = 0; i < n_values; i++) {
+        const gchar *name = names ? names[i] : NULL;
+        MyObject *self = my_object_new_full (values[i], NULL);
+        MyObjectPrivate *priv = my_object_get_instance_private (self);
+        
+        if (name && strlen (name) >= NAME_INLINE_SIZE) {
+            /* Sealed, so that later names do not grow the shared block */
+            my_object_get_cold (self)->name_arena = my_name_arena_ref (arena);
+            priv->name_arena_sealed = TRUE;
+            priv->name = (gchar *) my_name_arena_insert (arena, name);
+            priv->name_storage = NAME_STORAGE_ARENA;
+        } else if (name) {
+            my_object_store_name (self, name);
+        }
+        
+        g_ptr_array_add (objects, self);
+    }
+    
+    if (arena)
+        my_name_arena_unref (arena);
+    
+    return objects;
+}
+
+/**
+ * my_object_clone:
+ * @self: a #MyObject
+ *
+ * Creates a new object of the same type as @self with its current value,
+ * name and #MyObject:intern-names setting. The clone shares the name
+ * buffer of @self instead of copying it; the first my_object_set_name()
+ * on either object gives that object a buffer of its own.
+ *
+ * The clone is an ordinary object: it is never a view, is not atomic or
+ * sharded, and delivers notifications synchronously. Properties added by
+ * subclasses are not copied.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_clone (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectPrivate *clone_priv;
+    MyObject *clone;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    clone = g_object_new (G_OBJECT_TYPE (self), NULL);
+    clone_priv = my_object_get_instance_private (clone);
+    
+    clone_priv->value = my_object_load_value (self);
+    if (clone_priv->cold)
+        clone_priv->cold->notified_value = clone_priv->value;
+    clone_priv->intern_names = priv->intern_names;
+    
+    switch (priv->name_storage) {
+        case NAME_STORAGE_HEAP:
+            clone_priv->name = g_ref_string_acquire (priv->name);
+            break;
+        case NAME_STORAGE_ARENA:
+            /* Sealed, the source's arena is not ours to insert into */
+            my_object_get_cold (clone)->name_arena = my_name_arena_ref (priv->cold->name_arena);
+            clone_priv->name_arena_sealed = TRUE;
+            clone_priv->name = priv->name;
+            break;
+        case NAME_STORAGE_INLINE:
+            memcpy (my_object_get_cold (clone)->name_inline,
+                    priv->cold->name_inline, NAME_INLINE_SIZE);
+            clone_priv->name = clone_priv->cold->name_inline;
+            break;
+        case NAME_STORAGE_INTERNED:
+        case NAME_STORAGE_NONE:
+            clone_priv->name = priv->name;
+            break;
+    }
+    clone_priv->name_storage = priv->name_storage;
+    
+    return clone;
+}
+
+/**
+ * my_object_new_atomic:
+ * @initial_value: the initial value to set
+ *
+ * Creates a new #MyObject in atomic mode (see #MyObject:atomic). The
+ * value may be modified from any thread; notify::value and
+ * #MyObject::value-changed are coalesced and emitted from the
+ * thread-default #GMainContext of the calling thread, carrying the most
+ * recent value. Pending deliveries hold a reference on the object.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_new_atomic (gint initial_value)
+{
+    MyObject *self = g_object_new (MY_TYPE_OBJECT, "atomic", TRUE, NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    *priv->storage = initial_value;
+    priv->cold->notified_value = initial_value;
+    
+    return self;
+}
+
+/**
+ * my_object_new_sharded:
+ * @initial_value: the initial value to set
+ *
+ * Creates a new #MyObject in sharded mode (see #MyObject:sharded), for
+ * counters that many threads increment at once. The object behaves like
+ * one created with my_object_new_atomic(), except that
+ * my_object_increment(), my_object_decrement() and my_object_add() add
+ * to a cache-line-sized shard picked by the calling thread, so that
+ * writers on different threads do not contend for a cache line and
+ * write throughput grows with the number of threads.
+ *
+ * Reading the value folds the shards, which costs one load per shard.
+ * While other threads are adding, a read may miss additions that
+ * completed just before it, but it never reports an addition twice and
+ * every completed addition is eventually visible. my_object_set_value()
+ * is implemented as the addition of the difference to the value it
+ * reads, so additions racing with it are kept rather than overwritten,
+ * and my_object_fetch_add() returns the value read before its addition.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_new_sharded (gint initial_value)
+{
+    MyObject *self = g_object_new (MY_TYPE_OBJECT, "sharded", TRUE, NULL);
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    *priv->storage = initial_value;
+    priv->cold->notified_value = initial_value;
+    
+    return self;
+}
+
+/**
+ * my_object_set_value:
+ * @self: a #MyObject
+ * @value: the new value to set
+ *
+ * Sets the value property of the object.
+ */
+void
+my_object_set_value (MyObject *self, gint value)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    STATS_ADD (self, n_set_value, 1);
+#if defined(MY_OBJECT_ENABLE_STATS)
+    if (my_object_load_value (self) == value)
+        STATS_ADD (self, n_set_value_noop, 1);
+#endif
+    
+    TRACE_BEGIN (set_value, self, value);
+    my_object_store_value (self, value);
+    TRACE_END (set_value, self, value);
+}
+
+/**
+ * my_object_get_value:
+ * @self: a #MyObject
+ *
+ * Gets the current value of the object.
+ *
+ * Returns: the current value
+ */
+gint
+my_object_get_value (MyObject *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    
+    return my_object_load_value (self);
+}
+
+/**
+ * my_object_set_name:
+ * @self: a #MyObject
+ * @name: (nullable): the new name to set
+ *
+ * Sets the name property of the object. An object returned by
+ * my_object_store_get_object() keeps its current name if the store
+ * cannot persist the new one; my_object_store_sync() reports the error.
+ */
+void
+my_object_set_name (MyObject *self, const gchar *name)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    /* Interned names are equal exactly when the pointers are */
+    if (priv->name_storage == NAME_STORAGE_INTERNED &&
+        priv->intern_names && name != NULL) {
+        const gchar *interned = g_intern_string (name);
+        
+        if (interned == priv->name || !my_object_persist_name (self, interned))
+            return;
+        
+        my_object_clear_name (self);
+        priv->name = (gchar *) interned;
+        priv->name_storage = NAME_STORAGE_INTERNED;
+        
+        my_object_name_changed (self);
+        return;
+    }
+    
+    if (g_strcmp0 (priv->name, name) != 0 && my_object_persist_name (self, name)) {
+        my_object_store_name (self, name);
+        my_object_name_changed (self);
+    }
+}
+
+/**
+ * my_object_get_name:
+ * @self: a #MyObject
+ *
+ * Gets the current name of the object.
+ *
+ * Returns: (nullable): the current name or %NULL
+ */
+const gchar *
+my_object_get_name (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    return priv->name;
+}
+
+/**
+ * my_object_get_name_quark:
+ * @self: a #MyObject
+ *
+ * Gets the current name as a #GQuark, so that names can be compared and
+ * hashed without string operations. The quark is computed on first use
+ * after each name change and cached.
+ *
+ * Quarks are never freed: every distinct name passed through here stays
+ * allocated until the process exits. Avoid this for names that are
+ * generated or change over the life of an object, such as IDs or the
+ * names of pooled objects; #MyObjectRegistry does not use quarks.
+ *
+ * Returns: the quark of the current name, or 0 if the name is %NULL
+ */
+GQuark
+my_object_get_name_quark (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    
+    if (priv->name == NULL)
+        return 0;
+    
+    /* Only objects that already have a cold block keep the quark */
+    if (priv->cold == NULL)
+        return g_quark_from_string (priv->name);
+    
+    if (priv->cold->name_quark == 0)
+        priv->cold->name_quark = g_quark_from_string (priv->name);
+    
+    return priv->cold->name_quark;
+}
+
+/**
+ * my_object_set_intern_names:
+ * @self: a #MyObject
+ * @intern_names: whether to intern names
+ *
+ * Sets the #MyObject:intern-names property. The current name, if any,
+ * is converted to the new storage.
+ */
+void
+my_object_set_intern_names (MyObject *self, gboolean intern_names)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    intern_names = !!intern_names;
+    if (priv->intern_names == intern_names)
+        return;
+    
+    priv->intern_names = intern_names;
+    if (priv->name)
+        my_object_store_name (self, priv->name);
+    
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INTERN_NAMES]);
+}
+
+/**
+ * my_object_get_intern_names:
+ * @self: a #MyObject
+ *
+ * Gets the #MyObject:intern-names property.
+ *
+ * Returns: whether names are interned
+ */
+gboolean
+my_object_get_intern_names (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), FALSE);
+    
+    return priv->intern_names;
+}
+
+/**
+ * my_object_increment:
+ * @self: a #MyObject
+ *
+ * Increments the value by 1.
+ */
+void
+my_object_increment (MyObject *self)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    my_object_add_internal (self, 1);
+}
+
+/**
+ * my_object_decrement:
+ * @self: a #MyObject
+ *
+ * Decrements the value by 1.
+ */
+void
+my_object_decrement (MyObject *self)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    my_object_add_internal (self, -1);
+}
+
+/**
+ * my_object_add:
+ * @self: a #MyObject
+ * @delta: the amount to add, may be negative
+ *
+ * Adds @delta to the value in a single step, emitting at most one
+ * notification. This replaces calling my_object_increment() or
+ * my_object_decrement() in a loop. The value wraps around on overflow.
+ */
+void
+my_object_add (MyObject *self, gint delta)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    my_object_add_internal (self, delta);
+}
+
+/**
+ * my_object_fetch_add:
+ * @self: a #MyObject
+ * @delta: the amount to add, may be negative
+ *
+ * Like my_object_add(), but returns the value from before the addition.
+ * In atomic mode the read and the addition happen as one atomic
+ * operation.
+ *
+ * Returns: the previous value
+ */
+gint
+my_object_fetch_add (MyObject *self, gint delta)
+{
+    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    
+    return my_object_fetch_add_internal (self, delta);
+}
+
+/**
+ * my_object_to_string:
+ * @self: a #MyObject
+ *
+ * Creates a string representation of the object.
+ *
+ * Returns: (transfer full): a newly allocated string representation
+ */
+gchar *
+my_object_to_string (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    gint value;
+    gchar *str;
+    gsize len;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    /* Measure, then format into an exactly sized allocation */
+    value = my_object_load_value (self);
+    len = my_object_format_parts ("MyObject", priv->name, value, NULL, 0);
+    str = g_malloc (len + 1);
+    my_object_format_parts ("MyObject", priv->name, value, str, len);
+    str[len] = '\0';
+    
+    return str;
+}
+
+/**
+ * my_object_peek_string:
+ * @self: a #MyObject
+ *
+ * Gets the representation returned by my_object_to_string() without
+ * copying it. The string is built on the first call and kept with the
+ * object; later calls return it as is while the value and name stay the
+ * same, and otherwise rebuild it, in place unless the name changed.
+ *
+ * The string belongs to @self. It is rewritten or freed by the first
+ * call after a change, so copy it to keep it. Like my_object_set_name(),
+ * this must not be called from several threads at once.
+ *
+ * Returns: (transfer none): the string representation of @self
+ */
+const gchar *
+my_object_peek_string (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold;
+    MyObjectStringCache *cache;
+    gint value;
+    gsize len;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    /* Comparing values also catches changes made through a collection
+     * slot or by other threads, which never pass through a setter here */
+    value = my_object_load_value (self);
+    cold = my_object_get_cold (self);
+    cache = cold->string_cache;
+    if (G_LIKELY (cache && cache->value == value))
+        return cache->str;
+    
+    if (!cache) {
+        len = my_object_format_parts ("MyObject", priv->name, G_MININT, NULL, 0);
+        cache = g_malloc (G_STRUCT_OFFSET (MyObjectStringCache, str) + len + 1);
+        cold->string_cache = cache;
+    }
+    
+    len = my_object_format_parts ("MyObject", priv->name, value, NULL, 0);
+    my_object_format_parts ("MyObject", priv->name, value, cache->str, len);
+    cache->str[len] = '\0';
+    cache->value = value;
+    
+    return cache->str;
+}
+
+/**
+ * my_object_format_into:
+ * @self: a #MyObject
+ * @out: the #GString to append to
+ *
+ * Appends the representation returned by my_object_to_string() to @out.
+ * No memory is allocated unless @out needs to grow.
+ */
+void
+my_object_format_into (MyObject *self, GString *out)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    gint value;
+    gsize len;
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (out != NULL);
+    
+    value = my_object_load_value (self);
+    len = my_object_format_parts ("MyObject", priv->name, value, NULL, 0);
+    
+    g_string_set_size (out, out->len + len);
+    my_object_format_parts ("MyObject", priv->name, value,
+                            out->str + out->len - len, len);
+}
+
+/**
+ * my_object_format_to_buffer: (skip)
+ * @self: a #MyObject
+ * @buf: (nullable): the buffer to write to
+ * @len: the size of @buf in bytes
+ *
+ * Writes the representation returned by my_object_to_string() into
+ * @buf without allocating. Like snprintf(), at most @len bytes are
+ * written including the terminating nul, so the output is truncated when
+ * @buf is too small. Passing %NULL and 0 measures the representation.
+ *
+ * Returns: the length of the full representation, excluding the nul
+ */
+gsize
+my_object_format_to_buffer (MyObject *self, gchar *buf, gsize len)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    gsize needed;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    g_return_val_if_fail (buf != NULL || len == 0, 0);
+    
+    needed = my_object_format_parts ("MyObject", priv->name,
+                                     my_object_load_value (self), buf, len);
+    if (len > 0)
+        buf[MIN (needed, len - 1)] = '\0';
+    
+    return needed;
+}
+
+/**
+ * my_object_serialize:
+ * @self: a #MyObject
+ *
+ * Encodes the value and name of @self in a compact, versioned binary
+ * record that my_object_deserialize() turns back into an object. The
+ * encoding is little-endian on every host. Signal handlers, the
+ * #MyObject:atomic mode and the #MyObject:intern-names setting are not
+ * part of the record.
+ *
+ * Returns: (transfer full): the serialized record
+ */
+GBytes *
+my_object_serialize (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    const gchar *name;
+    gsize name_len;
+    guint8 *data;
+    guint32 field;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    name = priv->name;
+    name_len = name ? strlen (name) : 0;
+    g_return_val_if_fail (name_len <= G_MAXUINT32, NULL);
+    
+    data = g_malloc (RECORD_HEADER_SIZE + name_len);
+    data[0] = MY_OBJECT_RECORD_VERSION;
+    data[1] = name ? RECORD_FLAG_HAS_NAME : 0;
+    field = GUINT32_TO_LE ((guint32) my_object_load_value (self));
+    memcpy (data + 2, &field, 4);
+    field = GUINT32_TO_LE ((guint32) name_len);
+    memcpy (data + 6, &field, 4);
+    if (name_len > 0)
+        memcpy (data + RECORD_HEADER_SIZE, name, name_len);
+    
+    return g_bytes_new_take (data, RECORD_HEADER_SIZE + name_len);
+}
+
+/**
+ * my_object_deserialize:
+ * @bytes: a record produced by my_object_serialize()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Creates a new #MyObject from a record produced by
+ * my_object_serialize(). Fails with %MY_OBJECT_ERROR_UNSUPPORTED_VERSION
+ * for records written by a newer format version and with
+ * %MY_OBJECT_ERROR_INVALID_DATA for truncated or malformed records.
+ *
+ * Returns: (transfer full): a new #MyObject, or %NULL on error
+ */
+MyObject *
+my_object_deserialize (GBytes *bytes, GError **error)
+{
+    const guint8 *data;
+    gsize size;
+    guint32 value, name_len;
+    MyObject *self;
+    
+    g_return_val_if_fail (bytes != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+    
+    data = g_bytes_get_data (bytes, &size);
+    
+    if (size < RECORD_HEADER_SIZE) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                     "Record is truncated (%" G_GSIZE_FORMAT " bytes)", size);
+        return NULL;
+    }
+    
+    if (data[0] != MY_OBJECT_RECORD_VERSION) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_UNSUPPORTED_VERSION,
+                     "Unsupported record version %u", data[0]);
+        return NULL;
+    }
+    
+    memcpy (&value, data + 2, 4);
+    memcpy (&name_len, data + 6, 4);
+    value = GUINT32_FROM_LE (value);
+    name_len = GUINT32_FROM_LE (name_len);
+    
+    if ((data[1] & ~RECORD_FLAG_HAS_NAME) != 0 ||
+        (!(data[1] & RECORD_FLAG_HAS_NAME) && name_len != 0) ||
+        size - RECORD_HEADER_SIZE != name_len ||
+        memchr (data + RECORD_HEADER_SIZE, '\0', name_len) != NULL) {
+        g_set_error_literal (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                             "Record is malformed");
+        return NULL;
+    }
+    
+    if (data[1] & RECORD_FLAG_HAS_NAME) {
+        gchar *name = g_strndup ((const gchar *) data + RECORD_HEADER_SIZE, name_len);
+        
+        self = my_object_new_full ((gint) value, name);
+        g_free (name);
+    } else {
+        self = my_object_new_full ((gint) value, NULL);
+    }
+    
+    return self;
+}
+
+/**
+ * my_object_begin_update:
+ * @self: a #MyObject
+ *
+ * Starts a batch of modifications. Until the matching call to
+ * my_object_end_update(), changes to the value are applied immediately
+ * but neither #GObject::notify nor #MyObject::value-changed is emitted
+ * for them. Other property notifications are queued as with
+ * g_object_freeze_notify().
+ *
+ * Calls may be nested; only the outermost pair delimits the batch.
+ *
+ * If @self has a notify context, as every atomic and sharded object
+ * does, each call acquires it with g_main_context_acquire() until the
+ * matching my_object_end_update(), so that deferred deliveries wait for
+ * the batch instead of racing with it. Such batches must be opened and
+ * ended on a thread that can acquire the context: the thread running
+ * it, or any thread while no other thread does. Elsewhere no batch is
+ * opened and %FALSE is returned; the caller may still make its changes,
+ * which are then reported one by one, but must not call
+ * my_object_end_update().
+ *
+ * Returns: %TRUE if the batch was opened and must be ended with
+ *   my_object_end_update()
+ */
+gboolean
+my_object_begin_update (MyObject *self)
+{
+    MyObjectCold *cold;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), FALSE);
+    
+    cold = my_object_get_cold (self);
+    if (cold->notify_context && !g_main_context_acquire (cold->notify_context))
+        return FALSE;
+    
+    if (cold->update_depth++ == 0)
+        cold->batch_start_value = my_object_load_value (self);
+    
+    g_object_freeze_notify (G_OBJECT (self));
+    
+    return TRUE;
+}
+
+/**
+ * my_object_end_update:
+ * @self: a #MyObject
+ *
+ * Ends a batch opened by a call to my_object_begin_update() that
+ * returned %TRUE, on the same thread. When the outermost
+ * batch ends and the value differs from the one it had when the batch
+ * started, a single notify::value and a single #MyObject::value-changed
+ * carrying the final value are emitted, after any notifications for other
+ * properties that were queued during the batch.
+ */
+void
+my_object_end_update (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (priv->cold && priv->cold->update_depth > 0);
+    g_return_if_fail (priv->cold->notify_context == NULL ||
+                      g_main_context_is_owner (priv->cold->notify_context));
+    
+    gint value = my_object_load_value (self);
+    gboolean changed = --priv->cold->update_depth == 0 &&
+                       value != priv->cold->batch_start_value;
+    
+    g_object_thaw_notify (G_OBJECT (self));
+    
+    if (changed)
+        my_object_report_change (self, value);
+    
+    /* Queued deliveries may run from here on */
+    if (priv->cold->notify_context)
+        g_main_context_release (priv->cold->notify_context);
+}
+
+/**
+ * my_object_emit_value_changed:
+ * @self: a #MyObject
+ * @new_value: the new value
+ *
+ * Explicitly emits the value-changed signal.
+ * This is typically called internally when the value changes.
+ */
+void
+my_object_emit_value_changed (MyObject *self, gint new_value)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    my_object_emit_value_changed_internal (self, new_value);
+}
+
+/**
+ * my_object_set_notify_context:
+ * @self: a #MyObject
+ * @context: (nullable): the #GMainContext to deliver changes on, or %NULL
+ *
+ * Moves delivery of value changes off the writer. With a @context set,
+ * my_object_set_value() and the other modifiers only store the value and
+ * queue the object; notify::value and #MyObject::value-changed are then
+ * emitted from @context, once per queued wave, carrying the latest value.
+ * Intermediate values written before the delivery runs are not reported.
+ * The value may then be written from another thread than the one running
+ * @context, as long as only one thread writes at a time; atomic objects
+ * allow concurrent writers.
+ *
+ * Passing %NULL restores synchronous delivery. Atomic objects always
+ * defer and start out with the thread-default context of the thread that
+ * created them, so %NULL is not accepted for them. A change queued before
+ * the context is replaced is still delivered on the previous context.
+ * The context cannot be replaced inside a batch, which holds it; see
+ * my_object_begin_update().
+ */
+void
+my_object_set_notify_context (MyObject *self, GMainContext *context)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold;
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (context != NULL || !priv->atomic);
+    g_return_if_fail (priv->cold == NULL || priv->cold->update_depth == 0);
+    
+    if (context == my_object_get_notify_context (self))
+        return;
+    
+    cold = my_object_get_cold (self);
+    if (context)
+        g_main_context_ref (context);
+    g_clear_pointer (&cold->notify_context, g_main_context_unref);
+    
+    cold->notify_context = context;
+    cold->notify_queue = context ? my_notify_queue_get (context) : NULL;
+}
+
+/**
+ * my_object_get_notify_context:
+ * @self: a #MyObject
+ *
+ * Gets the context set with my_object_set_notify_context().
+ *
+ * Returns: (transfer none) (nullable): the notify context, or %NULL if
+ *   changes are delivered synchronously
+ */
+GMainContext *
+my_object_get_notify_context (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), NULL);
+    
+    return priv->cold ? priv->cold->notify_context : NULL;
+}
+
+gint
+my_object_get_reported_value (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    if (priv->cold && priv->cold->notify_queue)
+        return priv->cold->notified_value;
+    if (priv->cold && priv->cold->update_depth > 0)
+        return priv->cold->batch_start_value;
+    
+    return my_object_load_value (self);
+}
+
+/* Returns the watch set, created to compare against the last value
+ * listeners were told about */
+static MyWatchSet *
+my_object_ensure_watches (MyObject *self)
+{
+    MyObjectCold *cold = my_object_get_cold (self);
+    
+    if (cold->watches == NULL)
+        cold->watches = my_watch_set_new (my_object_get_reported_value (self));
+    
+    return cold->watches;
+}
+
+/**
+ * my_object_add_watch:
+ * @self: a #MyObject
+ * @kind: the condition to check
+ * @threshold: the threshold, or the delta for %MY_WATCH_DELTA
+ * @func: (scope notified) (closure user_data) (destroy destroy): the
+ *   function to call when the condition is met
+ * @user_data: data to pass to @func
+ * @destroy: (nullable): called on @user_data when the watch is removed
+ *
+ * Calls @func whenever a reported value change meets the condition of
+ * @kind. Watches see the same changes as #MyObject::value-changed: once
+ * per batch, and on the notify context for deferred delivery. They are
+ * checked before any signal handler runs.
+ *
+ * Unlike a handler that filters inside its body, a watch whose condition
+ * is not met costs nothing per change: thresholds are kept sorted, so a
+ * change only looks at the watches between the old and the new value.
+ * Thousands of watches on one object cost O(log n) per update.
+ *
+ * Watches must be added and removed on the thread that delivers the
+ * changes of @self.
+ *
+ * Returns: the watch ID, greater than 0, for my_object_remove_watch()
+ */
+guint
+my_object_add_watch (MyObject      *self,
+                     MyWatchKind    kind,
+                     gint           threshold,
+                     MyWatchFunc    func,
+                     gpointer       user_data,
+                     GDestroyNotify destroy)
+{
+    g_return_val_if_fail (MY_IS_OBJECT (self), 0);
+    g_return_val_if_fail (kind <= MY_WATCH_DELTA, 0);
+    g_return_val_if_fail (kind != MY_WATCH_DELTA || threshold >= 0, 0);
+    g_return_val_if_fail (func != NULL, 0);
+    
+    return my_watch_set_add (my_object_ensure_watches (self), kind, threshold,
+                             func, user_data, destroy);
+}
+
+/**
+ * my_object_remove_watch:
+ * @self: a #MyObject
+ * @watch_id: an ID returned by my_object_add_watch()
+ *
+ * Removes a watch. It is safe to remove a watch, including the one being
+ * called, from inside a #MyWatchFunc.
+ */
+void
+my_object_remove_watch (MyObject *self, guint watch_id)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    if (!priv->cold || !priv->cold->watches ||
+        !my_watch_set_remove (priv->cold->watches, watch_id))
+        g_warning ("No watch with ID %u on object %p", watch_id, self);
+}
+
+/**
+ * my_object_get_stats:
+ * @type: %MY_TYPE_OBJECT or a type derived from it
+ * @stats: (out caller-allocates): return location for the counters
+ *
+ * Reads the instrumentation counters of @type. Counters are kept for
+ * each concrete type separately, so the counters of %MY_TYPE_OBJECT do
+ * not include instances of subclasses. They are cumulative since the
+ * start of the process, except for @n_alive.
+ *
+ * The counters are only maintained when the library is built with
+ * MY_OBJECT_ENABLE_STATS defined (make STATS=1); otherwise @stats is
+ * zeroed and %FALSE is returned. Reads are not synchronized with each
+ * other, so counters updated concurrently may be slightly inconsistent.
+ *
+ * Returns: %TRUE if the library collects statistics
+ */
+gboolean
+my_object_get_stats (GType type, MyObjectStats *stats)
+{
+    g_return_val_if_fail (g_type_is_a (type, MY_TYPE_OBJECT), FALSE);
+    g_return_val_if_fail (stats != NULL, FALSE);
+    
+    memset (stats, 0, sizeof *stats);
+    
+#if defined(MY_OBJECT_ENABLE_STATS)
+    MyObjectTypeStats *type_stats = my_object_stats_for_type (type, FALSE);
+    
+    if (type_stats) {
+        stats->n_alive = (gsize) g_atomic_pointer_get (&type_stats->n_alive);
+        stats->n_set_value = (gsize) g_atomic_pointer_get (&type_stats->n_set_value);
+        stats->n_set_value_noop = (gsize) g_atomic_pointer_get (&type_stats->n_set_value_noop);
+        stats->n_signals_emitted = (gsize) g_atomic_pointer_get (&type_stats->n_signals_emitted);
+        stats->handler_time_ns = (gsize) g_atomic_pointer_get (&type_stats->handler_time_ns);
+        stats->n_name_reallocs = (gsize) g_atomic_pointer_get (&type_stats->n_name_reallocs);
+    }
+    
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/* Internal API shared with the collection types, see myobject-private.h */
+
+void
+my_object_attach_storage (MyObject          *self,
+                          gint              *storage,
+                          GObject           *owner,
+                          guint              index,
+                          MyObjectDetachFunc detach)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold;
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (priv->cold == NULL || priv->cold->storage_owner == NULL);
+    g_return_if_fail (!priv->atomic);
+    
+    priv->storage = storage;
+    cold = my_object_get_cold (self);
+    cold->storage_owner = g_object_ref (owner);
+    cold->storage_index = index;
+    cold->storage_detach = detach;
+}
+
+void
+my_object_attach_name_storage (MyObject               *self,
+                               MyObjectPersistNameFunc persist_name)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (priv->cold && priv->cold->storage_owner != NULL);
+    
+    priv->cold->storage_persist_name = persist_name;
+}
+
+void
+my_object_relocate_storage (MyObject *self, gint *storage)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    priv->storage = storage;
+}
+
+void
+my_object_storage_changed (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    /* Inside a batch the change is reported by my_object_end_update() */
+    if (priv->cold->update_depth == 0)
+        my_object_report_change (self, *priv->storage);
+}
+
+void
+my_object_set_name_arena (MyObject *self, MyNameArena *arena)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold;
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    if (arena == (priv->cold ? priv->cold->name_arena : NULL))
+        return;
+    
+    if (arena)
+        my_name_arena_ref (arena);
+    
+    /* The current name may live in the arena being replaced */
+    if (priv->name_storage == NAME_STORAGE_ARENA) {
+        gchar *name = g_ref_string_new (priv->name);
+        
+        my_object_clear_name (self);
+        priv->name = name;
+        priv->name_storage = NAME_STORAGE_HEAP;
+    }
+    
+    cold = my_object_get_cold (self);
+    if (cold->name_arena)
+        my_name_arena_unref (cold->name_arena);
+    cold->name_arena = arena;
+    priv->name_arena_sealed = FALSE;
+}
+
+void
+my_object_add_value_hook (MyObject *self, MyObjectValueHook func, gpointer data)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (func != NULL);
+    
+    my_watch_set_add_hook (my_object_ensure_watches (self), func, data);
+}
+
+void
+my_object_remove_value_hook (MyObject *self, MyObjectValueHook func, gpointer data)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    if (!priv->cold || !priv->cold->watches ||
+        !my_watch_set_remove_hook (priv->cold->watches, func, data))
+        g_warning ("No such value hook on object %p", self);
+}
+
+void
+my_object_add_name_hook (MyObject *self, MyObjectNameHook func, gpointer data)
+{
+    g_return_if_fail (MY_IS_OBJECT (self));
+    g_return_if_fail (func != NULL);
+    
+    my_watch_set_add_name_hook (my_object_ensure_watches (self), func, data);
+}
+
+void
+my_object_remove_name_hook (MyObject *self, MyObjectNameHook func, gpointer data)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_if_fail (MY_IS_OBJECT (self));
+    
+    if (!priv->cold || !priv->cold->watches ||
+        !my_watch_set_remove_name_hook (priv->cold->watches, func, data))
+        g_warning ("No such name hook on object %p", self);
+}
+
+gboolean
+my_object_share_name (MyObject     *self,
+                      const gchar **name,
+                      gchar       **name_ref,
+                      MyNameArena **arena)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    *name = priv->name;
+    *name_ref = NULL;
+    *arena = NULL;
+    
+    switch (priv->name_storage) {
+        case NAME_STORAGE_HEAP:
+            *name_ref = g_ref_string_acquire (priv->name);
+            return TRUE;
+        case NAME_STORAGE_ARENA:
+            *arena = my_name_arena_ref (priv->cold->name_arena);
+            return TRUE;
+        case NAME_STORAGE_INTERNED:
+        case NAME_STORAGE_NONE:
+            return TRUE;
+        case NAME_STORAGE_INLINE:
+            break;
+    }
+    
+    return FALSE;
+}
+
+gboolean
+my_object_reset (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_return_val_if_fail (MY_IS_OBJECT (self), FALSE);
+    g_return_val_if_fail (priv->cold == NULL || priv->cold->update_depth == 0, FALSE);
+    
+    /* Views and atomic objects are tied to state a reset cannot undo */
+    if (priv->atomic || (priv->cold && priv->cold->storage_owner))
+        return FALSE;
+    
+    g_signal_handlers_destroy (self);
+    my_object_set_notify_context (self, NULL);
+    
+    *priv->storage = 0;
+    
+    /* Internal hooks outlive a reset and see the value and name go */
+    if (priv->cold && priv->cold->watches) {
+        my_watch_set_reset (priv->cold->watches, priv->cold->notified_value);
+        my_watch_set_update (priv->cold->watches, self, 0);
+    }
+    if (priv->cold)
+        priv->cold->notified_value = 0;
+    if (priv->name) {
+        my_object_clear_name (self);
+        if (priv->cold && priv->cold->watches)
+            my_watch_set_name_changed (priv->cold->watches, self);
+    }
+    
+    return TRUE;
+}
+
+void
+my_object_deliver_deferred (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    MyObjectCold *cold = priv->cold;
+    
+    /* Clear first so that writes racing with this delivery queue again */
+    g_atomic_int_set (&cold->notify_pending, FALSE);
+    
+    /* my_object_end_update() reports changes made inside a batch. The
+     * batch holds the context, so it is open only if this thread opened
+     * it, and update_depth is never read while another thread writes it */
+    if (cold->update_depth == 0) {
+        gint value = cold->shards_block ? my_object_fold_shards (self)
+                                        : g_atomic_int_get (priv->storage);
+        
+        if (value != cold->notified_value)
+            my_object_value_changed_internal (self, value);
+    }
+    
+    g_object_unref (self);
+}
+
+void
+my_object_drop_deferred (MyObject *self)
+{
+    MyObjectPrivate *priv = my_object_get_instance_private (self);
+    
+    g_atomic_int_set (&priv->cold->notify_pending, FALSE);
+    g_object_unref (self);
+}
@@ -2,6 +2,7 @@
 #define MY_OBJECT_H
 
 #include <glib-object.h>
+#include "myobject-export.h"
 
 G_BEGIN_DECLS
 
@@ -16,17 +17,94 @@ typedef struct _MyObject MyObject;
 typedef struct _MyObjectClass MyObjectClass;
 typedef struct _MyObjectPrivate MyObjectPrivate;
 
+/**
+ * MY_OBJECT_ERROR:
+ *
+ * Error domain for #MyObject operations. Errors in this domain will be
+ * from the #MyObjectError enumeration.
+ */
+#define MY_OBJECT_ERROR (my_object_error_quark ())
+
+/**
+ * MyObjectError:
+ * @MY_OBJECT_ERROR_INVALID_DATA: serialized data is truncated or malformed
+ * @MY_OBJECT_ERROR_UNSUPPORTED_VERSION: serialized data uses a format
+ *   version this library does not understand
+ * @MY_OBJECT_ERROR_NO_SPACE: a fixed-size store has no room left
+ * @MY_OBJECT_ERROR_NOT_SUPPORTED: the operation is not available on this
+ *   platform
+ *
+ * Error codes returned by #MyObject functions.
+ */
+typedef enum {
+    MY_OBJECT_ERROR_INVALID_DATA,
+    MY_OBJECT_ERROR_UNSUPPORTED_VERSION,
+    MY_OBJECT_ERROR_NO_SPACE,
+    MY_OBJECT_ERROR_NOT_SUPPORTED
+} MyObjectError;
+
+/**
+ * MyWatchKind:
+ * @MY_WATCH_ABOVE: fires when the value rises from at or below the
+ *   threshold to above it
+ * @MY_WATCH_BELOW: fires when the value falls from at or above the
+ *   threshold to below it
+ * @MY_WATCH_DELTA: fires when the value has moved by more than the
+ *   threshold, a non-negative delta, since the watch was added or last
+ *   fired
+ *
+ * The condition a watch added with my_object_add_watch() checks.
+ */
+typedef enum {
+    MY_WATCH_ABOVE,
+    MY_WATCH_BELOW,
+    MY_WATCH_DELTA
+} MyWatchKind;
+
+/**
+ * MyObjectStats:
+ * @n_alive: instances constructed and not yet finalized
+ * @n_set_value: calls to my_object_set_value()
+ * @n_set_value_noop: calls to my_object_set_value() that did not change
+ *   the value
+ * @n_signals_emitted: #GObject::notify and #MyObject::value-changed
+ *   emissions for value changes
+ * @handler_time_ns: time spent in those emissions, in nanoseconds
+ * @n_name_reallocs: names copied to a new heap allocation
+ *
+ * Instrumentation counters for one type, see my_object_get_stats().
+ */
+typedef struct {
+    guint64 n_alive;
+    guint64 n_set_value;
+    guint64 n_set_value_noop;
+    guint64 n_signals_emitted;
+    guint64 handler_time_ns;
+    guint64 n_name_reallocs;
+} MyObjectStats;
+
+/**
+ * MyWatchFunc:
+ * @object: the watched object
+ * @value: the value that made the watch fire
+ * @user_data: the data passed to my_object_add_watch()
+ *
+ * Called when the condition of a watch is met.
+ */
+typedef void (*MyWatchFunc) (MyObject *object, gint value, gpointer user_data);
+
 /**
  * MyObject:
  *
  * An example GObject class that demonstrates proper GObject implementation
  * with GObject Introspection support.
+ *
+ * Since ABI version 2 the instance structure is exactly a #GObject. All
+ * state lives in the private data GLib places in front of it, so
+ * subclasses must not rely on any member beyond @parent_instance.
  */
 struct _MyObject {
     GObject parent_instance;
-    
-    /*< private >*/
-    MyObjectPrivate *priv;
 };
 
 /**
@@ -46,26 +124,99 @@ struct _MyObjectClass {
     gpointer padding[12];
 };
 
+MY_OBJECT_EXPORT
 GType my_object_get_type (void) G_GNUC_CONST;
+MY_OBJECT_EXPORT
+GQuark my_object_error_quark (void);
 
 /* Constructors */
+MY_OBJECT_EXPORT
 MyObject *my_object_new (void);
+MY_OBJECT_EXPORT
 MyObject *my_object_new_with_value (gint initial_value);
+MY_OBJECT_EXPORT
+MyObject *my_object_new_full (gint initial_value, const gchar *name);
+MY_OBJECT_EXPORT
+GPtrArray *my_object_new_many (const gint          *values,
+                               const gchar * const *names,
+                               guint                n_values);
+MY_OBJECT_EXPORT
+MyObject *my_object_clone (MyObject *self);
+MY_OBJECT_EXPORT
+MyObject *my_object_new_atomic (gint initial_value);
+MY_OBJECT_EXPORT
+MyObject *my_object_new_sharded (gint initial_value);
 
 /* Property getters/setters */
+MY_OBJECT_EXPORT
 void my_object_set_value (MyObject *self, gint value);
+MY_OBJECT_EXPORT
 gint my_object_get_value (MyObject *self);
 
+MY_OBJECT_EXPORT
 void my_object_set_name (MyObject *self, const gchar *name);
+MY_OBJECT_EXPORT
 const gchar *my_object_get_name (MyObject *self);
+MY_OBJECT_EXPORT
+GQuark my_object_get_name_quark (MyObject *self);
+
+MY_OBJECT_EXPORT
+void my_object_set_intern_names (MyObject *self, gboolean intern_names);
+MY_OBJECT_EXPORT
+gboolean my_object_get_intern_names (MyObject *self);
 
 /* Methods */
+MY_OBJECT_EXPORT
 void my_object_increment (MyObject *self);
+MY_OBJECT_EXPORT
 void my_object_decrement (MyObject *self);
+MY_OBJECT_EXPORT
+void my_object_add (MyObject *self, gint delta);
+MY_OBJECT_EXPORT
+gint my_object_fetch_add (MyObject *self, gint delta);
+MY_OBJECT_EXPORT
 gchar *my_object_to_string (MyObject *self);
+MY_OBJECT_EXPORT
+const gchar *my_object_peek_string (MyObject *self);
+MY_OBJECT_EXPORT
+void my_object_format_into (MyObject *self, GString *out);
+MY_OBJECT_EXPORT
+gsize my_object_format_to_buffer (MyObject *self, gchar *buf, gsize len);
+
+/* Serialization */
+MY_OBJECT_EXPORT
+GBytes *my_object_serialize (MyObject *self);
+MY_OBJECT_EXPORT
+MyObject *my_object_deserialize (GBytes *bytes, GError **error);
+
+/* Batched updates */
+MY_OBJECT_EXPORT
+gboolean my_object_begin_update (MyObject *self);
+MY_OBJECT_EXPORT
+void my_object_end_update (MyObject *self);
 
 /* Signals */
+MY_OBJECT_EXPORT
 void my_object_emit_value_changed (MyObject *self, gint new_value);
+MY_OBJECT_EXPORT
+void my_object_set_notify_context (MyObject *self, GMainContext *context);
+MY_OBJECT_EXPORT
+GMainContext *my_object_get_notify_context (MyObject *self);
+
+/* Watches */
+MY_OBJECT_EXPORT
+guint my_object_add_watch (MyObject      *self,
+                           MyWatchKind    kind,
+                           gint           threshold,
+                           MyWatchFunc    func,
+                           gpointer       user_data,
+                           GDestroyNotify destroy);
+MY_OBJECT_EXPORT
+void my_object_remove_watch (MyObject *self, guint watch_id);
+
+/* Instrumentation */
+MY_OBJECT_EXPORT
+gboolean my_object_get_stats (GType type, MyObjectStats *stats);
 
 G_END_DECLS
 
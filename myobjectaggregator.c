@@ -0,0 +1,311 @@
+#include "myobjectaggregator.h"
+#include "myobject-private.h"
+
+/**
+ * SECTION:myobjectaggregator
+ * @short_description: Totals and rankings kept up to date incrementally
+ * @title: MyObjectAggregator
+ * @stability: Unstable
+ * @include: myobjectaggregator.h
+ *
+ * MyObjectAggregator maintains the count, sum, minimum and maximum of the
+ * values of a set of #MyObject instances, and their ranking, as the
+ * values change. Queries do not visit the members: the count and sum
+ * cost O(1), the minimum and maximum O(log n), and the top n objects
+ * O(log n + n).
+ *
+ * Members are observed through an internal hook called with every value
+ * change they report, the same changes #MyObject::value-changed sees, so
+ * no signal closure is involved. Each change updates the sum and moves
+ * the member within a #GSequence ordered by value, in O(log n).
+ *
+ * An aggregator holds a reference on each member. It must be used from
+ * the thread that delivers its members' changes, which for atomic
+ * members is their notify context.
+ */
+
+typedef struct {
+    MyObjectAggregator *aggregator;
+    MyObject *object;
+    gint value;
+    guint64 serial;             /* equal values: earlier members rank higher */
+    GSequenceIter *iter;
+} MyObjectAggregatorMember;
+
+/**
+ * MyObjectAggregator:
+ *
+ * A set of #MyObject instances with incrementally maintained aggregates.
+ */
+struct _MyObjectAggregator {
+    GObject parent_instance;
+    
+    GSequence *ranking;         /* MyObjectAggregatorMember, ascending */
+    GHashTable *members;        /* MyObject -> MyObjectAggregatorMember */
+    gint64 sum;
+    guint64 next_serial;
+};
+
+G_DEFINE_TYPE (MyObjectAggregator, my_object_aggregator, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_aggregator_finalize (GObject *object);
+
+static gint
+my_object_aggregator_member_compare (gconstpointer a,
+                                     gconstpointer b,
+                                     gpointer      user_data)
+{
+    const MyObjectAggregatorMember *x = a;
+    const MyObjectAggregatorMember *y = b;
+    
+    if (x->value != y->value)
+        return x->value < y->value ? -1 : 1;
+    
+    return (x->serial < y->serial) - (x->serial > y->serial);
+}
+
+/* Value hook of every member */
+static void
+my_object_aggregator_member_changed (MyObject *object, gint value, gpointer data)
+{
+    MyObjectAggregatorMember *member = data;
+    
+    member->aggregator->sum += (gint64) value - member->value;
+    member->value = value;
+    g_sequence_sort_changed (member->iter, my_object_aggregator_member_compare, NULL);
+}
+
+static void
+my_object_aggregator_member_free (gpointer data)
+{
+    MyObjectAggregatorMember *member = data;
+    
+    my_object_remove_value_hook (member->object,
+                                 my_object_aggregator_member_changed, member);
+    g_object_unref (member->object);
+    g_free (member);
+}
+
+/* Class initialization */
+static void
+my_object_aggregator_class_init (MyObjectAggregatorClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_aggregator_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_aggregator_init (MyObjectAggregator *self)
+{
+    self->ranking = g_sequence_new (my_object_aggregator_member_free);
+    self->members = g_hash_table_new (g_direct_hash, g_direct_equal);
+    self->sum = 0;
+    self->next_serial = 0;
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_aggregator_finalize (GObject *object)
+{
+    MyObjectAggregator *self = MY_OBJECT_AGGREGATOR (object);
+    
+    g_hash_table_unref (self->members);
+    g_sequence_free (self->ranking);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_aggregator_parent_class)->finalize (object);
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_aggregator_new:
+ *
+ * Creates a new, empty #MyObjectAggregator.
+ *
+ * Returns: (transfer full): a new #MyObjectAggregator
+ */
+MyObjectAggregator *
+my_object_aggregator_new (void)
+{
+    return g_object_new (MY_TYPE_OBJECT_AGGREGATOR, NULL);
+}
+
+/**
+ * my_object_aggregator_add:
+ * @self: a #MyObjectAggregator
+ * @object: the #MyObject to add
+ *
+ * Adds @object to the set, counting its current value.
+ *
+ * Returns: %TRUE if @object was added, %FALSE if it already was a member
+ */
+gboolean
+my_object_aggregator_add (MyObjectAggregator *self, MyObject *object)
+{
+    MyObjectAggregatorMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), FALSE);
+    g_return_val_if_fail (MY_IS_OBJECT (object), FALSE);
+    
+    if (g_hash_table_contains (self->members, object))
+        return FALSE;
+    
+    member = g_new (MyObjectAggregatorMember, 1);
+    member->aggregator = self;
+    member->object = g_object_ref (object);
+    /* Start from what the hook compares against, not a mid-batch value */
+    member->value = my_object_get_reported_value (object);
+    member->serial = self->next_serial++;
+    member->iter = g_sequence_insert_sorted (self->ranking, member,
+                                             my_object_aggregator_member_compare,
+                                             NULL);
+    
+    g_hash_table_insert (self->members, object, member);
+    self->sum += member->value;
+    my_object_add_value_hook (object, my_object_aggregator_member_changed, member);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_aggregator_remove:
+ * @self: a #MyObjectAggregator
+ * @object: the #MyObject to remove
+ *
+ * Removes @object from the set and releases the reference on it.
+ *
+ * Returns: %TRUE if @object was removed, %FALSE if it was not a member
+ */
+gboolean
+my_object_aggregator_remove (MyObjectAggregator *self, MyObject *object)
+{
+    MyObjectAggregatorMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), FALSE);
+    g_return_val_if_fail (MY_IS_OBJECT (object), FALSE);
+    
+    member = g_hash_table_lookup (self->members, object);
+    if (!member)
+        return FALSE;
+    
+    self->sum -= member->value;
+    g_hash_table_remove (self->members, object);
+    g_sequence_remove (member->iter);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_aggregator_get_count:
+ * @self: a #MyObjectAggregator
+ *
+ * Gets the number of members.
+ *
+ * Returns: the number of objects in the set
+ */
+guint
+my_object_aggregator_get_count (MyObjectAggregator *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), 0);
+    
+    return g_hash_table_size (self->members);
+}
+
+/**
+ * my_object_aggregator_get_sum:
+ * @self: a #MyObjectAggregator
+ *
+ * Gets the sum of the values of the members, without wrap-around.
+ *
+ * Returns: the sum, 0 for an empty set
+ */
+gint64
+my_object_aggregator_get_sum (MyObjectAggregator *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), 0);
+    
+    return self->sum;
+}
+
+/**
+ * my_object_aggregator_get_min:
+ * @self: a #MyObjectAggregator
+ *
+ * Gets the smallest value of any member.
+ *
+ * Returns: the minimum, 0 for an empty set
+ */
+gint
+my_object_aggregator_get_min (MyObjectAggregator *self)
+{
+    MyObjectAggregatorMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), 0);
+    
+    if (g_sequence_is_empty (self->ranking))
+        return 0;
+    
+    member = g_sequence_get (g_sequence_get_begin_iter (self->ranking));
+    
+    return member->value;
+}
+
+/**
+ * my_object_aggregator_get_max:
+ * @self: a #MyObjectAggregator
+ *
+ * Gets the largest value of any member.
+ *
+ * Returns: the maximum, 0 for an empty set
+ */
+gint
+my_object_aggregator_get_max (MyObjectAggregator *self)
+{
+    MyObjectAggregatorMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), 0);
+    
+    if (g_sequence_is_empty (self->ranking))
+        return 0;
+    
+    member = g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter (self->ranking)));
+    
+    return member->value;
+}
+
+/**
+ * my_object_aggregator_get_top:
+ * @self: a #MyObjectAggregator
+ * @n: the number of objects to return
+ *
+ * Gets the @n members with the largest values, largest first. Members
+ * with equal values come in the order they were added in.
+ *
+ * Returns: (transfer full) (element-type MyObject): at most @n members
+ */
+GPtrArray *
+my_object_aggregator_get_top (MyObjectAggregator *self, guint n)
+{
+    GPtrArray *top;
+    GSequenceIter *iter;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_AGGREGATOR (self), NULL);
+    
+    top = g_ptr_array_new_full (MIN (n, g_hash_table_size (self->members)),
+                                g_object_unref);
+    iter = g_sequence_get_end_iter (self->ranking);
+    
+    while (top->len < n && !g_sequence_iter_is_begin (iter)) {
+        MyObjectAggregatorMember *member;
+        
+        iter = g_sequence_iter_prev (iter);
+        member = g_sequence_get (iter);
+        g_ptr_array_add (top, g_object_ref (member->object));
+    }
+    
+    return top;
+}
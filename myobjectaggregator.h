@@ -0,0 +1,56 @@
+#ifndef MY_OBJECT_AGGREGATOR_H
+#define MY_OBJECT_AGGREGATOR_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_AGGREGATOR (my_object_aggregator_get_type())
+#define MY_OBJECT_AGGREGATOR(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_AGGREGATOR, MyObjectAggregator))
+#define MY_OBJECT_AGGREGATOR_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_AGGREGATOR, MyObjectAggregatorClass))
+#define MY_IS_OBJECT_AGGREGATOR(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_AGGREGATOR))
+#define MY_IS_OBJECT_AGGREGATOR_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_AGGREGATOR))
+#define MY_OBJECT_AGGREGATOR_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_AGGREGATOR, MyObjectAggregatorClass))
+
+typedef struct _MyObjectAggregator MyObjectAggregator;
+typedef struct _MyObjectAggregatorClass MyObjectAggregatorClass;
+
+/**
+ * MyObjectAggregatorClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectAggregator.
+ */
+struct _MyObjectAggregatorClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_aggregator_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectAggregator *my_object_aggregator_new (void);
+
+/* Membership */
+MY_OBJECT_EXPORT
+gboolean my_object_aggregator_add (MyObjectAggregator *self, MyObject *object);
+MY_OBJECT_EXPORT
+gboolean my_object_aggregator_remove (MyObjectAggregator *self, MyObject *object);
+
+/* Queries */
+MY_OBJECT_EXPORT
+guint my_object_aggregator_get_count (MyObjectAggregator *self);
+MY_OBJECT_EXPORT
+gint64 my_object_aggregator_get_sum (MyObjectAggregator *self);
+MY_OBJECT_EXPORT
+gint my_object_aggregator_get_min (MyObjectAggregator *self);
+MY_OBJECT_EXPORT
+gint my_object_aggregator_get_max (MyObjectAggregator *self);
+MY_OBJECT_EXPORT
+GPtrArray *my_object_aggregator_get_top (MyObjectAggregator *self, guint n);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_AGGREGATOR_H */
@@ -0,0 +1,1146 @@
+#include "myobjectarray.h"
+#include "myobject-private.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MY_HAVE_AVX2_KERNELS 1
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * SECTION:myobjectarray
+ * @short_description: A contiguous collection of MyObject values
+ * @title: MyObjectArray
+ * @stability: Unstable
+ * @include: myobjectarray.h
+ *
+ * MyObjectArray stores the values of many objects in a single contiguous
+ * column of integers, so that aggregates such as the sum of all values
+ * can be computed without visiting one heap object per element. The
+ * aggregate operations use SSE2, AVX2 or NEON kernels when the CPU
+ * supports them. Their `_parallel` variants, and
+ * my_object_array_foreach_parallel(), also split the column across a
+ * shared thread pool, which pays off for arrays of millions of elements.
+ *
+ * my_object_array_get_object() returns a #MyObject view of one element.
+ * A view reads and writes the array slot directly and emits the usual
+ * notifications, including when the element is modified through the
+ * array. Views are created on demand and keep the array alive.
+ */
+
+/**
+ * MyObjectArray:
+ *
+ * A structure-of-arrays collection of #MyObject values.
+ */
+struct _MyObjectArray {
+    GObject parent_instance;
+    
+    gint *values;
+    guint len;
+    guint capacity;
+    
+    /* Live views indexed like @values, allocated on first use */
+    MyObject **views;
+    guint n_views;
+};
+
+G_DEFINE_TYPE (MyObjectArray, my_object_array, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_array_finalize (GObject *object);
+
+/* Aggregate kernels
+ *
+ * Each kernel processes as many elements as fit in its vector width and
+ * finishes the remainder with the scalar version. Additions wrap around
+ * like the rest of the MyObject arithmetic.
+ */
+
+typedef struct {
+    gint64 (*sum) (const gint *values, gsize n);
+    gint (*min) (const gint *values, gsize n);
+    gint (*max) (const gint *values, gsize n);
+    void (*add) (gint *values, gsize n, gint delta);
+} MyObjectArrayKernels;
+
+static gint64
+sum_scalar (const gint *values, gsize n)
+{
+    gint64 sum = 0;
+    
+    for (gsize i = 0; i < n; i++)
+        sum += values[i];
+    
+    return sum;
+}
+
+static gint
+min_scalar (const gint *values, gsize n)
+{
+    gint min = G_MAXINT;
+    
+    for (gsize i = 0; i < n; i++)
+        if (values[i] < min)
+            min = values[i];
+    
+    return min;
+}
+
+static gint
+max_scalar (const gint *values, gsize n)
+{
+    gint max = G_MININT;
+    
+    for (gsize i = 0; i < n; i++)
+        if (values[i] > max)
+            max = values[i];
+    
+    return max;
+}
+
+static void
+add_scalar (gint *values, gsize n, gint delta)
+{
+    for (gsize i = 0; i < n; i++)
+        values[i] = (gint) ((guint) values[i] + (guint) delta);
+}
+
+static const MyObjectArrayKernels scalar_kernels = {
+    sum_scalar, min_scalar, max_scalar, add_scalar
+};
+
+#if defined(__SSE2__)
+static gint64
+sum_sse2 (const gint *values, gsize n)
+{
+    __m128i acc = _mm_setzero_si128 ();
+    gint64 lanes[2];
+    gsize i = 0;
+    
+    /* Sign-extend to two 64-bit lanes so the sum cannot overflow */
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (values + i));
+        __m128i sign = _mm_srai_epi32 (v, 31);
+        
+        acc = _mm_add_epi64 (acc, _mm_unpacklo_epi32 (v, sign));
+        acc = _mm_add_epi64 (acc, _mm_unpackhi_epi32 (v, sign));
+    }
+    
+    _mm_storeu_si128 ((__m128i *) lanes, acc);
+    
+    return lanes[0] + lanes[1] + sum_scalar (values + i, n - i);
+}
+
+static gint
+min_sse2 (const gint *values, gsize n)
+{
+    __m128i acc = _mm_set1_epi32 (G_MAXINT);
+    gint lanes[4];
+    gsize i = 0;
+    
+    /* SSE2 has no _mm_min_epi32, select through a comparison mask */
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (values + i));
+        __m128i lt = _mm_cmplt_epi32 (v, acc);
+        
+        acc = _mm_or_si128 (_mm_and_si128 (lt, v), _mm_andnot_si128 (lt, acc));
+    }
+    
+    _mm_storeu_si128 ((__m128i *) lanes, acc);
+    
+    return MIN (MIN (MIN (lanes[0], lanes[1]), MIN (lanes[2], lanes[3])),
+                min_scalar (values + i, n - i));
+}
+
+static gint
+max_sse2 (const gint *values, gsize n)
+{
+    __m128i acc = _mm_set1_epi32 (G_MININT);
+    gint lanes[4];
+    gsize i = 0;
+    
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (values + i));
+        __m128i gt = _mm_cmpgt_epi32 (v, acc);
+        
+        acc = _mm_or_si128 (_mm_and_si128 (gt, v), _mm_andnot_si128 (gt, acc));
+    }
+    
+    _mm_storeu_si128 ((__m128i *) lanes, acc);
+    
+    return MAX (MAX (MAX (lanes[0], lanes[1]), MAX (lanes[2], lanes[3])),
+                max_scalar (values + i, n - i));
+}
+
+static void
+add_sse2 (gint *values, gsize n, gint delta)
+{
+    __m128i d = _mm_set1_epi32 (delta);
+    gsize i = 0;
+    
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (values + i));
+        
+        _mm_storeu_si128 ((__m128i *) (values + i), _mm_add_epi32 (v, d));
+    }
+    
+    add_scalar (values + i, n - i, delta);
+}
+
+static const MyObjectArrayKernels sse2_kernels = {
+    sum_sse2, min_sse2, max_sse2, add_sse2
+};
+#endif /* __SSE2__ */
+
+#if defined(MY_HAVE_AVX2_KERNELS)
+__attribute__ ((target ("avx2")))
+static gint64
+sum_avx2 (const gint *values, gsize n)
+{
+    __m256i acc = _mm256_setzero_si256 ();
+    gint64 lanes[4];
+    gsize i = 0;
+    
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256 ((const __m256i *) (values + i));
+        
+        acc = _mm256_add_epi64 (acc, _mm256_cvtepi32_epi64 (_mm256_castsi256_si128 (v)));
+        acc = _mm256_add_epi64 (acc, _mm256_cvtepi32_epi64 (_mm256_extracti128_si256 (v, 1)));
+    }
+    
+    _mm256_storeu_si256 ((__m256i *) lanes, acc);
+    
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           sum_scalar (values + i, n - i);
+}
+
+__attribute__ ((target ("avx2")))
+static gint
+min_avx2 (const gint *values, gsize n)
+{
+    __m256i acc = _mm256_set1_epi32 (G_MAXINT);
+    gint lanes[8];
+    gint min;
+    gsize i = 0;
+    
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_min_epi32 (acc, _mm256_loadu_si256 ((const __m256i *) (values + i)));
+    
+    _mm256_storeu_si256 ((__m256i *) lanes, acc);
+    
+    min = min_scalar (values + i, n - i);
+    for (guint lane = 0; lane < G_N_ELEMENTS (lanes); lane++)
+        min = MIN (min, lanes[lane]);
+    
+    return min;
+}
+
+__attribute__ ((target ("avx2")))
+static gint
+max_avx2 (const gint *values, gsize n)
+{
+    __m256i acc = _mm256_set1_epi32 (G_MININT);
+    gint lanes[8];
+    gint max;
+    gsize i = 0;
+    
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_max_epi32 (acc, _mm256_loadu_si256 ((const __m256i *) (values + i)));
+    
+    _mm256_storeu_si256 ((__m256i *) lanes, acc);
+    
+    max = max_scalar (values + i, n - i);
+    for (guint lane = 0; lane < G_N_ELEMENTS (lanes); lane++)
+        max = MAX (max, lanes[lane]);
+    
+    return max;
+}
+
+__attribute__ ((target ("avx2")))
+static void
+add_avx2 (gint *values, gsize n, gint delta)
+{
+    __m256i d = _mm256_set1_epi32 (delta);
+    gsize i = 0;
+    
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256 ((const __m256i *) (values + i));
+        
+        _mm256_storeu_si256 ((__m256i *) (values + i), _mm256_add_epi32 (v, d));
+    }
+    
+    add_scalar (values + i, n - i, delta);
+}
+
+static const MyObjectArrayKernels avx2_kernels = {
+    sum_avx2, min_avx2, max_avx2, add_avx2
+};
+#endif /* MY_HAVE_AVX2_KERNELS */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+static gint64
+sum_neon (const gint *values, gsize n)
+{
+    int64x2_t acc = vdupq_n_s64 (0);
+    gsize i = 0;
+    
+    /* Pairwise add-accumulate into 64-bit lanes */
+    for (; i + 4 <= n; i += 4)
+        acc = vpadalq_s32 (acc, vld1q_s32 (values + i));
+    
+    return vgetq_lane_s64 (acc, 0) + vgetq_lane_s64 (acc, 1) +
+           sum_scalar (values + i, n - i);
+}
+
+static gint
+min_neon (const gint *values, gsize n)
+{
+    int32x4_t acc = vdupq_n_s32 (G_MAXINT);
+    gint lanes[4];
+    gsize i = 0;
+    
+    for (; i + 4 <= n; i += 4)
+        acc = vminq_s32 (acc, vld1q_s32 (values + i));
+    
+    vst1q_s32 (lanes, acc);
+    
+    return MIN (MIN (MIN (lanes[0], lanes[1]), MIN (lanes[2], lanes[3])),
+                min_scalar (values + i, n - i));
+}
+
+static gint
+max_neon (const gint *values, gsize n)
+{
+    int32x4_t acc = vdupq_n_s32 (G_MININT);
+    gint lanes[4];
+    gsize i = 0;
+    
+    for (; i + 4 <= n; i += 4)
+        acc = vmaxq_s32 (acc, vld1q_s32 (values + i));
+    
+    vst1q_s32 (lanes, acc);
+    
+    return MAX (MAX (MAX (lanes[0], lanes[1]), MAX (lanes[2], lanes[3])),
+                max_scalar (values + i, n - i));
+}
+
+static void
+add_neon (gint *values, gsize n, gint delta)
+{
+    int32x4_t d = vdupq_n_s32 (delta);
+    gsize i = 0;
+    
+    for (; i + 4 <= n; i += 4)
+        vst1q_s32 (values + i, vaddq_s32 (vld1q_s32 (values + i), d));
+    
+    add_scalar (values + i, n - i, delta);
+}
+
+static const MyObjectArrayKernels neon_kernels = {
+    sum_neon, min_neon, max_neon, add_neon
+};
+#endif /* __ARM_NEON */
+
+/* Picks the widest kernel set the running CPU supports, once */
+static const MyObjectArrayKernels *
+my_object_array_get_kernels (void)
+{
+    static const MyObjectArrayKernels *kernels = NULL;
+    
+    if (g_once_init_enter (&kernels)) {
+        const MyObjectArrayKernels *selected = &scalar_kernels;
+        
+#if defined(__SSE2__)
+        selected = &sse2_kernels;
+#endif
+#if defined(MY_HAVE_AVX2_KERNELS)
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx2"))
+            selected = &avx2_kernels;
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        selected = &neon_kernels;
+#endif
+        
+        g_once_init_leave (&kernels, selected);
+    }
+    
+    return kernels;
+}
+
+/* Class initialization */
+static void
+my_object_array_class_init (MyObjectArrayClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_array_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_array_init (MyObjectArray *self)
+{
+    self->values = NULL;
+    self->len = 0;
+    self->capacity = 0;
+    self->views = NULL;
+    self->n_views = 0;
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_array_finalize (GObject *object)
+{
+    MyObjectArray *self = MY_OBJECT_ARRAY (object);
+    
+    /* Views keep the array alive, so none can be left at this point */
+    g_free (self->values);
+    g_free (self->views);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_array_parent_class)->finalize (object);
+}
+
+/* Detach callback run when a view is finalized */
+static void
+my_object_array_detach_view (GObject *owner, guint index)
+{
+    MyObjectArray *self = MY_OBJECT_ARRAY (owner);
+    
+    self->views[index] = NULL;
+    self->n_views--;
+}
+
+/* Makes room for at least @needed elements, moving views along */
+static void
+my_object_array_reserve (MyObjectArray *self, guint needed)
+{
+    guint capacity = MAX (self->capacity, 16);
+    
+    if (needed <= self->capacity)
+        return;
+    
+    while (capacity < needed)
+        capacity *= 2;
+    
+    self->values = g_renew (gint, self->values, capacity);
+    
+    if (self->views) {
+        self->views = g_renew (MyObject *, self->views, capacity);
+        memset (self->views + self->capacity, 0,
+                (capacity - self->capacity) * sizeof (MyObject *));
+        
+        for (guint i = 0; self->n_views > 0 && i < self->len; i++)
+            if (self->views[i])
+                my_object_relocate_storage (self->views[i], &self->values[i]);
+    }
+    
+    self->capacity = capacity;
+}
+
+/* Emits change notifications on every live view after a bulk kernel */
+static void
+my_object_array_notify_views (MyObjectArray *self)
+{
+    if (self->n_views == 0)
+        return;
+    
+    for (guint i = 0; i < self->len; i++) {
+        MyObject *view = self->views[i];
+        
+        if (view) {
+            /* Handlers may drop the last reference to the view */
+            g_object_ref (view);
+            my_object_storage_changed (view);
+            g_object_unref (view);
+        }
+    }
+}
+
+/* Parallel execution
+ *
+ * A parallel operation splits the array into fixed-size chunks and hands
+ * each participating thread a contiguous run of them. A thread takes
+ * chunks from the front of its own run and, once that is empty, steals
+ * single chunks from the back of the other runs, so threads that were
+ * scheduled late or hit expensive elements do not hold up the rest. The
+ * calling thread takes part and returns once every chunk is done.
+ *
+ * Worker threads only ever touch the value column. Views whose value
+ * changes are recorded per chunk and notified by the calling thread
+ * afterwards, in index order.
+ */
+
+#define PARALLEL_CHUNK_SIZE (16 * 1024)
+
+typedef struct _ParallelJob ParallelJob;
+
+typedef void (*ParallelChunkFunc) (ParallelJob *job, guint chunk,
+                                   guint start, guint end);
+
+/* One thread's run of chunks, [next, end) */
+typedef struct {
+    GMutex lock;
+    guint next;
+    guint end;
+    ParallelJob *job;
+} ParallelRun;
+
+/* What a chunk leaves behind for the calling thread */
+typedef struct {
+    gint64 sum;
+    gint min;
+    gint max;
+    GArray *changed;        /* indices of views whose value changed, or NULL */
+} ParallelResult;
+
+struct _ParallelJob {
+    MyObjectArray *array;
+    ParallelChunkFunc func;
+    
+    /* Operation parameters */
+    gint delta;
+    MyObjectArrayForeachFunc foreach_func;
+    gpointer user_data;
+    
+    ParallelResult *results;    /* one per chunk */
+    guint n_chunks;
+    ParallelRun *runs;
+    guint n_runs;
+    
+    GMutex done_lock;
+    GCond done_cond;
+    guint n_running;            /* pool threads still working */
+};
+
+static void my_object_array_parallel_thread (gpointer data, gpointer pool_data);
+
+/* Shared by all arrays; NULL on single-processor machines */
+static GThreadPool *
+my_object_array_get_pool (void)
+{
+    static GThreadPool *pool = NULL;
+    static gsize initialized = 0;
+    
+    if (g_once_init_enter (&initialized)) {
+        guint n_processors = g_get_num_processors ();
+        
+        if (n_processors > 1)
+            pool = g_thread_pool_new (my_object_array_parallel_thread, NULL,
+                                      (gint) n_processors - 1, FALSE, NULL);
+        
+        g_once_init_leave (&initialized, 1);
+    }
+    
+    return pool;
+}
+
+/* Takes a chunk from run @self_index, or steals one from another run */
+static gboolean
+my_object_array_parallel_take (ParallelJob *job, guint self_index, guint *chunk)
+{
+    for (guint i = 0; i < job->n_runs; i++) {
+        ParallelRun *run = &job->runs[(self_index + i) % job->n_runs];
+        gboolean taken = FALSE;
+        
+        g_mutex_lock (&run->lock);
+        if (run->next < run->end) {
+            *chunk = i == 0 ? run->next++ : --run->end;
+            taken = TRUE;
+        }
+        g_mutex_unlock (&run->lock);
+        
+        if (taken)
+            return TRUE;
+    }
+    
+    return FALSE;
+}
+
+static void
+my_object_array_parallel_work (ParallelJob *job, guint run_index)
+{
+    guint chunk;
+    
+    while (my_object_array_parallel_take (job, run_index, &chunk)) {
+        guint start = chunk * PARALLEL_CHUNK_SIZE;
+        guint end = MIN (job->array->len - start, PARALLEL_CHUNK_SIZE) + start;
+        
+        job->func (job, chunk, start, end);
+    }
+}
+
+static void
+my_object_array_parallel_thread (gpointer data, gpointer pool_data)
+{
+    ParallelRun *run = data;
+    ParallelJob *job = run->job;
+    
+    my_object_array_parallel_work (job, (guint) (run - job->runs));
+    
+    g_mutex_lock (&job->done_lock);
+    if (--job->n_running == 0)
+        g_cond_signal (&job->done_cond);
+    g_mutex_unlock (&job->done_lock);
+}
+
+/* Runs @job over the whole array and fills in @job->results; the caller
+ * combines them and frees them with my_object_array_parallel_finish() */
+static void
+my_object_array_parallel_run (ParallelJob *job)
+{
+    GThreadPool *pool = my_object_array_get_pool ();
+    guint n_threads = pool ? g_get_num_processors () : 1;
+    
+    job->n_chunks = (job->array->len + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+    job->results = g_new0 (ParallelResult, job->n_chunks);
+    job->n_runs = MIN (job->n_chunks, n_threads);
+    job->runs = g_new (ParallelRun, job->n_runs);
+    
+    for (guint i = 0; i < job->n_runs; i++) {
+        g_mutex_init (&job->runs[i].lock);
+        job->runs[i].next = (guint) ((guint64) job->n_chunks * i / job->n_runs);
+        job->runs[i].end = (guint) ((guint64) job->n_chunks * (i + 1) / job->n_runs);
+        job->runs[i].job = job;
+    }
+    
+    g_mutex_init (&job->done_lock);
+    g_cond_init (&job->done_cond);
+    job->n_running = job->n_runs - 1;
+    
+    /* Runs whose thread cannot be started are stolen by the others */
+    for (guint i = 1; i < job->n_runs; i++) {
+        if (!g_thread_pool_push (pool, &job->runs[i], NULL)) {
+            g_mutex_lock (&job->done_lock);
+            job->n_running--;
+            g_mutex_unlock (&job->done_lock);
+        }
+    }
+    
+    my_object_array_parallel_work (job, 0);
+    
+    /* Pool threads may still be reading @job after its last chunk */
+    g_mutex_lock (&job->done_lock);
+    while (job->n_running > 0)
+        g_cond_wait (&job->done_cond, &job->done_lock);
+    g_mutex_unlock (&job->done_lock);
+    
+    for (guint i = 0; i < job->n_runs; i++)
+        g_mutex_clear (&job->runs[i].lock);
+    g_mutex_clear (&job->done_lock);
+    g_cond_clear (&job->done_cond);
+    g_free (job->runs);
+}
+
+/* Notifies the views recorded by the chunks, on the calling thread */
+static void
+my_object_array_parallel_finish (ParallelJob *job)
+{
+    MyObjectArray *self = job->array;
+    
+    for (guint chunk = 0; chunk < job->n_chunks; chunk++) {
+        GArray *changed = job->results[chunk].changed;
+        
+        if (!changed)
+            continue;
+        
+        for (guint i = 0; i < changed->len; i++) {
+            /* Earlier handlers may have dropped the view */
+            MyObject *view = self->views[g_array_index (changed, guint, i)];
+            
+            if (view) {
+                g_object_ref (view);
+                my_object_storage_changed (view);
+                g_object_unref (view);
+            }
+        }
+        
+        g_array_unref (changed);
+    }
+    
+    g_free (job->results);
+}
+
+static void
+parallel_chunk_sum (ParallelJob *job, guint chunk, guint start, guint end)
+{
+    job->results[chunk].sum =
+        my_object_array_get_kernels ()->sum (job->array->values + start, end - start);
+}
+
+static void
+parallel_chunk_min (ParallelJob *job, guint chunk, guint start, guint end)
+{
+    job->results[chunk].min =
+        my_object_array_get_kernels ()->min (job->array->values + start, end - start);
+}
+
+static void
+parallel_chunk_max (ParallelJob *job, guint chunk, guint start, guint end)
+{
+    job->results[chunk].max =
+        my_object_array_get_kernels ()->max (job->array->values + start, end - start);
+}
+
+static void
+parallel_chunk_add (ParallelJob *job, guint chunk, guint start, guint end)
+{
+    my_object_array_get_kernels ()->add (job->array->values + start, end - start,
+                                         job->delta);
+}
+
+static void
+parallel_chunk_foreach (ParallelJob *job, guint chunk, guint start, guint end)
+{
+    MyObjectArray *self = job->array;
+    MyObject **views = self->n_views > 0 ? self->views : NULL;
+    
+    for (guint i = start; i < end; i++) {
+        gint old_value = self->values[i];
+        
+        job->foreach_func (&self->values[i], i, job->user_data);
+        
+        if (views && views[i] && self->values[i] != old_value) {
+            if (!job->results[chunk].changed)
+                job->results[chunk].changed = g_array_new (FALSE, FALSE, sizeof (guint));
+            g_array_append_val (job->results[chunk].changed, i);
+        }
+    }
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_array_new:
+ *
+ * Creates a new, empty #MyObjectArray.
+ *
+ * Returns: (transfer full): a new #MyObjectArray
+ */
+MyObjectArray *
+my_object_array_new (void)
+{
+    return g_object_new (MY_TYPE_OBJECT_ARRAY, NULL);
+}
+
+/**
+ * my_object_array_new_from_values:
+ * @values: (array length=n_values): the initial values
+ * @n_values: the number of elements in @values
+ *
+ * Creates a new #MyObjectArray holding a copy of @values.
+ *
+ * Returns: (transfer full): a new #MyObjectArray
+ */
+MyObjectArray *
+my_object_array_new_from_values (const gint *values, guint n_values)
+{
+    MyObjectArray *self;
+    
+    g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+    
+    self = my_object_array_new ();
+    if (n_values > 0) {
+        my_object_array_reserve (self, n_values);
+        memcpy (self->values, values, n_values * sizeof (gint));
+        self->len = n_values;
+    }
+    
+    return self;
+}
+
+/**
+ * my_object_array_append:
+ * @self: a #MyObjectArray
+ * @value: the value of the new element
+ *
+ * Appends an element to the end of the array.
+ *
+ * Returns: the index of the new element
+ */
+guint
+my_object_array_append (MyObjectArray *self, gint value)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), 0);
+    g_return_val_if_fail (self->len < G_MAXUINT, 0);
+    
+    my_object_array_reserve (self, self->len + 1);
+    self->values[self->len] = value;
+    
+    return self->len++;
+}
+
+/**
+ * my_object_array_get_length:
+ * @self: a #MyObjectArray
+ *
+ * Gets the number of elements in the array.
+ *
+ * Returns: the number of elements
+ */
+guint
+my_object_array_get_length (MyObjectArray *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), 0);
+    
+    return self->len;
+}
+
+/**
+ * my_object_array_get_value:
+ * @self: a #MyObjectArray
+ * @index: the index of the element
+ *
+ * Gets the value of the element at @index.
+ *
+ * Returns: the value
+ */
+gint
+my_object_array_get_value (MyObjectArray *self, guint index)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), 0);
+    g_return_val_if_fail (index < self->len, 0);
+    
+    return self->values[index];
+}
+
+/**
+ * my_object_array_set_value:
+ * @self: a #MyObjectArray
+ * @index: the index of the element
+ * @value: the new value
+ *
+ * Sets the value of the element at @index. If a view of the element
+ * exists, this is equivalent to calling my_object_set_value() on it.
+ */
+void
+my_object_array_set_value (MyObjectArray *self, guint index, gint value)
+{
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    g_return_if_fail (index < self->len);
+    
+    if (self->views && self->views[index])
+        my_object_set_value (self->views[index], value);
+    else
+        self->values[index] = value;
+}
+
+/**
+ * my_object_array_get_values:
+ * @self: a #MyObjectArray
+ * @n_values: (out): return location for the number of elements
+ *
+ * Gets the value column of the array. The returned memory is only valid
+ * until the next element is appended.
+ *
+ * Returns: (array length=n_values) (transfer none) (nullable): the values
+ */
+const gint *
+my_object_array_get_values (MyObjectArray *self, guint *n_values)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), NULL);
+    g_return_val_if_fail (n_values != NULL, NULL);
+    
+    *n_values = self->len;
+    
+    return self->values;
+}
+
+/**
+ * my_object_array_get_object:
+ * @self: a #MyObjectArray
+ * @index: the index of the element
+ *
+ * Gets a #MyObject view of the element at @index. The view's value is
+ * the array slot itself, so changes made through either side are seen
+ * by the other. Repeated calls return the same view while it is alive.
+ * Views cannot be switched to atomic mode.
+ *
+ * Returns: (transfer full): the view of the element
+ */
+MyObject *
+my_object_array_get_object (MyObjectArray *self, guint index)
+{
+    MyObject *view;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), NULL);
+    g_return_val_if_fail (index < self->len, NULL);
+    
+    if (self->views == NULL)
+        self->views = g_new0 (MyObject *, self->capacity);
+    
+    if (self->views[index])
+        return g_object_ref (self->views[index]);
+    
+    view = my_object_new ();
+    my_object_attach_storage (view, &self->values[index], G_OBJECT (self),
+                              index, my_object_array_detach_view);
+    self->views[index] = view;
+    self->n_views++;
+    
+    return view;
+}
+
+/**
+ * my_object_array_sum:
+ * @self: a #MyObjectArray
+ *
+ * Computes the sum of all values without overflowing.
+ *
+ * Returns: the sum of all values, 0 for an empty array
+ */
+gint64
+my_object_array_sum (MyObjectArray *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), 0);
+    
+    return my_object_array_get_kernels ()->sum (self->values, self->len);
+}
+
+/**
+ * my_object_array_min:
+ * @self: a #MyObjectArray
+ *
+ * Finds the smallest value in the array.
+ *
+ * Returns: the smallest value, %G_MAXINT for an empty array
+ */
+gint
+my_object_array_min (MyObjectArray *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), G_MAXINT);
+    
+    return my_object_array_get_kernels ()->min (self->values, self->len);
+}
+
+/**
+ * my_object_array_max:
+ * @self: a #MyObjectArray
+ *
+ * Finds the largest value in the array.
+ *
+ * Returns: the largest value, %G_MININT for an empty array
+ */
+gint
+my_object_array_max (MyObjectArray *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), G_MININT);
+    
+    return my_object_array_get_kernels ()->max (self->values, self->len);
+}
+
+/**
+ * my_object_array_add_all:
+ * @self: a #MyObjectArray
+ * @delta: the amount to add to every element
+ *
+ * Adds @delta to every element, wrapping around on overflow. Views of
+ * the elements emit their change notifications once all elements have
+ * been updated.
+ */
+void
+my_object_array_add_all (MyObjectArray *self, gint delta)
+{
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    
+    if (delta == 0 || self->len == 0)
+        return;
+    
+    my_object_array_get_kernels ()->add (self->values, self->len, delta);
+    my_object_array_notify_views (self);
+}
+
+/**
+ * my_object_array_increment_all:
+ * @self: a #MyObjectArray
+ *
+ * Increments every element by 1, see my_object_array_add_all().
+ */
+void
+my_object_array_increment_all (MyObjectArray *self)
+{
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    
+    my_object_array_add_all (self, 1);
+}
+
+/**
+ * my_object_array_foreach_parallel:
+ * @self: a #MyObjectArray
+ * @func: (scope call): the function to call on every element
+ * @user_data: data to pass to @func
+ *
+ * Calls @func on every element, spreading the elements over a shared
+ * pool of threads. @func may be called from several threads at once and
+ * in any order; it may change the value it is given, but must not touch
+ * other elements, the array or its views, nor start another parallel
+ * operation.
+ *
+ * Views whose value @func changed emit their notifications from the
+ * calling thread after all elements have been visited, in index order,
+ * so their handlers run single-threaded as usual.
+ */
+void
+my_object_array_foreach_parallel (MyObjectArray           *self,
+                                  MyObjectArrayForeachFunc func,
+                                  gpointer                 user_data)
+{
+    ParallelJob job = { 0 };
+    
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    g_return_if_fail (func != NULL);
+    
+    if (self->len == 0)
+        return;
+    
+    job.array = self;
+    job.func = parallel_chunk_foreach;
+    job.foreach_func = func;
+    job.user_data = user_data;
+    
+    my_object_array_parallel_run (&job);
+    my_object_array_parallel_finish (&job);
+}
+
+/**
+ * my_object_array_sum_parallel:
+ * @self: a #MyObjectArray
+ *
+ * Computes the same as my_object_array_sum(), on several threads.
+ *
+ * Returns: the sum of all values, 0 for an empty array
+ */
+gint64
+my_object_array_sum_parallel (MyObjectArray *self)
+{
+    ParallelJob job = { 0 };
+    gint64 sum = 0;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), 0);
+    
+    if (self->len == 0)
+        return 0;
+    
+    job.array = self;
+    job.func = parallel_chunk_sum;
+    my_object_array_parallel_run (&job);
+    
+    for (guint chunk = 0; chunk < job.n_chunks; chunk++)
+        sum += job.results[chunk].sum;
+    
+    my_object_array_parallel_finish (&job);
+    
+    return sum;
+}
+
+/**
+ * my_object_array_min_parallel:
+ * @self: a #MyObjectArray
+ *
+ * Computes the same as my_object_array_min(), on several threads.
+ *
+ * Returns: the smallest value, %G_MAXINT for an empty array
+ */
+gint
+my_object_array_min_parallel (MyObjectArray *self)
+{
+    ParallelJob job = { 0 };
+    gint min = G_MAXINT;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), G_MAXINT);
+    
+    if (self->len == 0)
+        return G_MAXINT;
+    
+    job.array = self;
+    job.func = parallel_chunk_min;
+    my_object_array_parallel_run (&job);
+    
+    for (guint chunk = 0; chunk < job.n_chunks; chunk++)
+        min = MIN (min, job.results[chunk].min);
+    
+    my_object_array_parallel_finish (&job);
+    
+    return min;
+}
+
+/**
+ * my_object_array_max_parallel:
+ * @self: a #MyObjectArray
+ *
+ * Computes the same as my_object_array_max(), on several threads.
+ *
+ * Returns: the largest value, %G_MININT for an empty array
+ */
+gint
+my_object_array_max_parallel (MyObjectArray *self)
+{
+    ParallelJob job = { 0 };
+    gint max = G_MININT;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (self), G_MININT);
+    
+    if (self->len == 0)
+        return G_MININT;
+    
+    job.array = self;
+    job.func = parallel_chunk_max;
+    my_object_array_parallel_run (&job);
+    
+    for (guint chunk = 0; chunk < job.n_chunks; chunk++)
+        max = MAX (max, job.results[chunk].max);
+    
+    my_object_array_parallel_finish (&job);
+    
+    return max;
+}
+
+/**
+ * my_object_array_add_all_parallel:
+ * @self: a #MyObjectArray
+ * @delta: the amount to add to every element
+ *
+ * Does the same as my_object_array_add_all(), on several threads. Views
+ * are notified from the calling thread once all elements are updated.
+ */
+void
+my_object_array_add_all_parallel (MyObjectArray *self, gint delta)
+{
+    ParallelJob job = { 0 };
+    
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    
+    if (delta == 0 || self->len == 0)
+        return;
+    
+    job.array = self;
+    job.func = parallel_chunk_add;
+    job.delta = delta;
+    my_object_array_parallel_run (&job);
+    my_object_array_parallel_finish (&job);
+    
+    /* Every element changed, there is nothing to record per chunk */
+    my_object_array_notify_views (self);
+}
+
+/**
+ * my_object_array_increment_all_parallel:
+ * @self: a #MyObjectArray
+ *
+ * Increments every element by 1, see my_object_array_add_all_parallel().
+ */
+void
+my_object_array_increment_all_parallel (MyObjectArray *self)
+{
+    g_return_if_fail (MY_IS_OBJECT_ARRAY (self));
+    
+    my_object_array_add_all_parallel (self, 1);
+}
@@ -0,0 +1,94 @@
+#ifndef MY_OBJECT_ARRAY_H
+#define MY_OBJECT_ARRAY_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_ARRAY (my_object_array_get_type())
+#define MY_OBJECT_ARRAY(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_ARRAY, MyObjectArray))
+#define MY_OBJECT_ARRAY_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_ARRAY, MyObjectArrayClass))
+#define MY_IS_OBJECT_ARRAY(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_ARRAY))
+#define MY_IS_OBJECT_ARRAY_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_ARRAY))
+#define MY_OBJECT_ARRAY_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_ARRAY, MyObjectArrayClass))
+
+typedef struct _MyObjectArray MyObjectArray;
+typedef struct _MyObjectArrayClass MyObjectArrayClass;
+
+/**
+ * MyObjectArrayClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectArray.
+ */
+struct _MyObjectArrayClass {
+    GObjectClass parent_class;
+};
+
+/**
+ * MyObjectArrayForeachFunc:
+ * @value: (inout): the value of the element, which may be changed
+ * @index: the index of the element
+ * @user_data: the data passed to my_object_array_foreach_parallel()
+ *
+ * Called on every element by my_object_array_foreach_parallel(),
+ * possibly from several threads at once.
+ */
+typedef void (*MyObjectArrayForeachFunc) (gint *value, guint index, gpointer user_data);
+
+MY_OBJECT_EXPORT
+GType my_object_array_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectArray *my_object_array_new (void);
+MY_OBJECT_EXPORT
+MyObjectArray *my_object_array_new_from_values (const gint *values,
+                                                guint       n_values);
+
+/* Element access */
+MY_OBJECT_EXPORT
+guint my_object_array_append (MyObjectArray *self, gint value);
+MY_OBJECT_EXPORT
+guint my_object_array_get_length (MyObjectArray *self);
+MY_OBJECT_EXPORT
+gint my_object_array_get_value (MyObjectArray *self, guint index);
+MY_OBJECT_EXPORT
+void my_object_array_set_value (MyObjectArray *self, guint index, gint value);
+MY_OBJECT_EXPORT
+const gint *my_object_array_get_values (MyObjectArray *self, guint *n_values);
+MY_OBJECT_EXPORT
+MyObject *my_object_array_get_object (MyObjectArray *self, guint index);
+
+/* Aggregate kernels */
+MY_OBJECT_EXPORT
+gint64 my_object_array_sum (MyObjectArray *self);
+MY_OBJECT_EXPORT
+gint my_object_array_min (MyObjectArray *self);
+MY_OBJECT_EXPORT
+gint my_object_array_max (MyObjectArray *self);
+MY_OBJECT_EXPORT
+void my_object_array_increment_all (MyObjectArray *self);
+MY_OBJECT_EXPORT
+void my_object_array_add_all (MyObjectArray *self, gint delta);
+
+/* Parallel kernels */
+MY_OBJECT_EXPORT
+void my_object_array_foreach_parallel (MyObjectArray           *self,
+                                       MyObjectArrayForeachFunc func,
+                                       gpointer                 user_data);
+MY_OBJECT_EXPORT
+gint64 my_object_array_sum_parallel (MyObjectArray *self);
+MY_OBJECT_EXPORT
+gint my_object_array_min_parallel (MyObjectArray *self);
+MY_OBJECT_EXPORT
+gint my_object_array_max_parallel (MyObjectArray *self);
+MY_OBJECT_EXPORT
+void my_object_array_increment_all_parallel (MyObjectArray *self);
+MY_OBJECT_EXPORT
+void my_object_array_add_all_parallel (MyObjectArray *self, gint delta);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_ARRAY_H */
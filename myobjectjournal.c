@@ -0,0 +1,373 @@
+#include "myobjectjournal.h"
+#include "myobject-private.h"
+#include <string.h>
+
+/**
+ * SECTION:myobjectjournal
+ * @short_description: An ordered stream of object changes
+ * @title: MyObjectJournal
+ * @stability: Unstable
+ * @include: myobjectjournal.h
+ *
+ * MyObjectJournal records the changes of the objects added to it as
+ * compact #MyObjectJournalRecord entries, each with the id of the object,
+ * the field that changed, the new value or name and a sequence number.
+ * Records are appended through internal hooks, the way
+ * #MyObject::value-changed and #GObject::notify would be emitted, but
+ * without a closure invocation per change. A batch or a notify context
+ * coalesces changes for the journal as it does for signals.
+ *
+ * The records are kept in a ring buffer of fixed capacity. Consumers
+ * read them in batches with my_object_journal_read(), each keeping its
+ * own position, so several replicas can follow one journal. When the
+ * writer gets more than the capacity ahead of a consumer, the oldest
+ * records are overwritten; the consumer notices from the sequence number
+ * of the first record it gets and can resynchronize from the objects.
+ *
+ * Adding an object appends its current value and name, so a stream read
+ * from the start describes every member completely. The journal does not
+ * keep its members alive. It must be used from the thread that delivers
+ * its members' notifications.
+ */
+
+/**
+ * MyObjectJournal:
+ *
+ * A ring buffer of changes to a set of #MyObject instances.
+ */
+struct _MyObjectJournal {
+    GObject parent_instance;
+    
+    MyObjectJournalRecord *ring;    /* record n lives at n & mask */
+    guint mask;
+    guint64 next_sequence;
+    guint next_id;
+    GHashTable *members;            /* MyObject -> MyObjectJournalMember */
+};
+
+typedef struct {
+    MyObjectJournal *journal;
+    MyObject *object;
+    guint id;
+} MyObjectJournalMember;
+
+G_DEFINE_TYPE (MyObjectJournal, my_object_journal, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_journal_finalize (GObject *object);
+
+/* Takes a reference on the current name, reusing its GRefString when the
+ * object keeps it in one */
+static gchar *
+my_object_journal_ref_name (MyObject *object)
+{
+    const gchar *name;
+    gchar *name_ref;
+    MyNameArena *arena;
+    
+    if (my_object_share_name (object, &name, &name_ref, &arena) && name_ref)
+        return name_ref;
+    if (arena)
+        my_name_arena_unref (arena);
+    
+    return name ? g_ref_string_new (name) : NULL;
+}
+
+/* Appends a record, overwriting the oldest one when the ring is full;
+ * takes @name */
+static void
+my_object_journal_append (MyObjectJournal     *self,
+                          guint                object_id,
+                          MyObjectJournalField field,
+                          gint                 value,
+                          gchar               *name)
+{
+    MyObjectJournalRecord *record = &self->ring[self->next_sequence & self->mask];
+    
+    if (record->name)
+        g_ref_string_release (record->name);
+    
+    record->sequence = self->next_sequence++;
+    record->name = name;
+    record->object_id = object_id;
+    record->field = field;
+    record->value = value;
+}
+
+/* Value hook of every member */
+static void
+my_object_journal_member_value_changed (MyObject *object, gint value, gpointer data)
+{
+    MyObjectJournalMember *member = data;
+    
+    my_object_journal_append (member->journal, member->id,
+                              MY_OBJECT_JOURNAL_VALUE, value, NULL);
+}
+
+/* Name hook of every member */
+static void
+my_object_journal_member_renamed (MyObject *object, gpointer data)
+{
+    MyObjectJournalMember *member = data;
+    
+    my_object_journal_append (member->journal, member->id, MY_OBJECT_JOURNAL_NAME,
+                              0, my_object_journal_ref_name (object));
+}
+
+/* Unhooks and frees @member; its object is still alive */
+static void
+my_object_journal_member_forget (MyObjectJournalMember *member)
+{
+    my_object_remove_value_hook (member->object,
+                                 my_object_journal_member_value_changed, member);
+    my_object_remove_name_hook (member->object,
+                                my_object_journal_member_renamed, member);
+    g_free (member);
+}
+
+/* Runs while the object is disposed, before it is finalized */
+static void
+my_object_journal_member_disposed (gpointer data, GObject *where_the_object_was)
+{
+    MyObjectJournalMember *member = data;
+    
+    g_hash_table_remove (member->journal->members, member->object);
+    my_object_journal_member_forget (member);
+}
+
+/* Class initialization */
+static void
+my_object_journal_class_init (MyObjectJournalClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_journal_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_journal_init (MyObjectJournal *self)
+{
+    self->ring = NULL;
+    self->mask = 0;
+    self->next_sequence = 1;
+    self->next_id = 1;
+    self->members = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_journal_finalize (GObject *object)
+{
+    MyObjectJournal *self = MY_OBJECT_JOURNAL (object);
+    GHashTableIter iter;
+    gpointer member;
+    
+    g_hash_table_iter_init (&iter, self->members);
+    while (g_hash_table_iter_next (&iter, NULL, &member)) {
+        g_object_weak_unref (G_OBJECT (((MyObjectJournalMember *) member)->object),
+                             my_object_journal_member_disposed, member);
+        my_object_journal_member_forget (member);
+    }
+    g_hash_table_unref (self->members);
+    
+    if (self->ring)
+        my_object_journal_clear_records (self->ring, self->mask + 1);
+    g_free (self->ring);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_journal_parent_class)->finalize (object);
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_journal_new:
+ * @capacity: the number of records to keep, rounded up to a power of two
+ *
+ * Creates a new, empty #MyObjectJournal that keeps the last @capacity
+ * records.
+ *
+ * Returns: (transfer full): a new #MyObjectJournal
+ */
+MyObjectJournal *
+my_object_journal_new (guint capacity)
+{
+    MyObjectJournal *self;
+    guint size = 1;
+    
+    g_return_val_if_fail (capacity > 0 && capacity <= G_MAXUINT / 2 + 1, NULL);
+    
+    while (size < capacity)
+        size *= 2;
+    
+    self = g_object_new (MY_TYPE_OBJECT_JOURNAL, NULL);
+    self->ring = g_new0 (MyObjectJournalRecord, size);
+    self->mask = size - 1;
+    
+    return self;
+}
+
+/**
+ * my_object_journal_add:
+ * @self: a #MyObjectJournal
+ * @object: the #MyObject to record
+ *
+ * Starts recording the changes of @object, after a record of its
+ * current value and, if it has one, its name. Inside a batch the value
+ * recorded is the one from before the batch, which the batch's own
+ * change then follows. The journal does not take
+ * a reference on @object and stops recording when it is finalized.
+ *
+ * Returns: the id of @object in the records of @self, never 0; the same
+ *   id again if @object already was a member
+ */
+guint
+my_object_journal_add (MyObjectJournal *self, MyObject *object)
+{
+    MyObjectJournalMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_JOURNAL (self), 0);
+    g_return_val_if_fail (MY_IS_OBJECT (object), 0);
+    
+    member = g_hash_table_lookup (self->members, object);
+    if (member)
+        return member->id;
+    
+    member = g_new (MyObjectJournalMember, 1);
+    member->journal = self;
+    member->object = object;
+    member->id = self->next_id++;
+    
+    /* Replicas start from the value the hook compares later changes to */
+    my_object_journal_append (self, member->id, MY_OBJECT_JOURNAL_VALUE,
+                              my_object_get_reported_value (object), NULL);
+    if (my_object_get_name (object))
+        my_object_journal_member_renamed (object, member);
+    
+    g_hash_table_insert (self->members, object, member);
+    my_object_add_value_hook (object, my_object_journal_member_value_changed, member);
+    my_object_add_name_hook (object, my_object_journal_member_renamed, member);
+    g_object_weak_ref (G_OBJECT (object), my_object_journal_member_disposed, member);
+    
+    return member->id;
+}
+
+/**
+ * my_object_journal_remove:
+ * @self: a #MyObjectJournal
+ * @object: the #MyObject to stop recording
+ *
+ * Stops recording the changes of @object. Its records stay in the
+ * journal.
+ *
+ * Returns: %TRUE if @object was removed, %FALSE if it was not a member
+ */
+gboolean
+my_object_journal_remove (MyObjectJournal *self, MyObject *object)
+{
+    MyObjectJournalMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_JOURNAL (self), FALSE);
+    g_return_val_if_fail (MY_IS_OBJECT (object), FALSE);
+    
+    member = g_hash_table_lookup (self->members, object);
+    if (!member)
+        return FALSE;
+    
+    g_hash_table_remove (self->members, object);
+    g_object_weak_unref (G_OBJECT (object), my_object_journal_member_disposed, member);
+    my_object_journal_member_forget (member);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_journal_get_next_sequence:
+ * @self: a #MyObjectJournal
+ *
+ * Gets the sequence number the next record will have. A consumer that
+ * only wants changes from now on starts reading there.
+ *
+ * Returns: the sequence number of the next record
+ */
+guint64
+my_object_journal_get_next_sequence (MyObjectJournal *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_JOURNAL (self), 0);
+    
+    return self->next_sequence;
+}
+
+/**
+ * my_object_journal_read:
+ * @self: a #MyObjectJournal
+ * @sequence: (inout): the sequence number to read from, updated to the
+ *   one to read from next
+ * @records: (out caller-allocates) (array length=n_records): return
+ *   location for the records
+ * @n_records: the number of records that fit in @records
+ *
+ * Copies up to @n_records records, in order, starting at @sequence. If
+ * that record was overwritten already, reading starts at the oldest one
+ * kept, so the first record's sequence number is larger than @sequence
+ * was; the changes in between are lost.
+ *
+ * The copies hold references on their names; release them with
+ * my_object_journal_clear_records().
+ *
+ * Returns: the number of records copied, 0 when the consumer is up to date
+ */
+guint
+my_object_journal_read (MyObjectJournal       *self,
+                        guint64               *sequence,
+                        MyObjectJournalRecord *records,
+                        guint                  n_records)
+{
+    guint64 capacity, oldest, start;
+    guint count;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_JOURNAL (self), 0);
+    g_return_val_if_fail (sequence != NULL, 0);
+    g_return_val_if_fail (records != NULL || n_records == 0, 0);
+    
+    capacity = (guint64) self->mask + 1;
+    oldest = self->next_sequence > capacity ? self->next_sequence - capacity : 1;
+    start = MAX (*sequence, oldest);
+    
+    if (start >= self->next_sequence)
+        return 0;
+    
+    count = (guint) MIN ((guint64) n_records, self->next_sequence - start);
+    
+    for (guint i = 0; i < count; i++) {
+        records[i] = self->ring[(start + i) & self->mask];
+        if (records[i].name)
+            g_ref_string_acquire (records[i].name);
+    }
+    
+    *sequence = start + count;
+    
+    return count;
+}
+
+/**
+ * my_object_journal_clear_records:
+ * @records: (array length=n_records): records filled in by
+ *   my_object_journal_read()
+ * @n_records: the number of records
+ *
+ * Releases the names held by @records.
+ */
+void
+my_object_journal_clear_records (MyObjectJournalRecord *records, guint n_records)
+{
+    g_return_if_fail (records != NULL || n_records == 0);
+    
+    for (guint i = 0; i < n_records; i++) {
+        if (records[i].name) {
+            g_ref_string_release (records[i].name);
+            records[i].name = NULL;
+        }
+    }
+}
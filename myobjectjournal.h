@@ -0,0 +1,87 @@
+#ifndef MY_OBJECT_JOURNAL_H
+#define MY_OBJECT_JOURNAL_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_JOURNAL (my_object_journal_get_type())
+#define MY_OBJECT_JOURNAL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_JOURNAL, MyObjectJournal))
+#define MY_OBJECT_JOURNAL_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_JOURNAL, MyObjectJournalClass))
+#define MY_IS_OBJECT_JOURNAL(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_JOURNAL))
+#define MY_IS_OBJECT_JOURNAL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_JOURNAL))
+#define MY_OBJECT_JOURNAL_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_JOURNAL, MyObjectJournalClass))
+
+typedef struct _MyObjectJournal MyObjectJournal;
+typedef struct _MyObjectJournalClass MyObjectJournalClass;
+
+/**
+ * MyObjectJournalClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectJournal.
+ */
+struct _MyObjectJournalClass {
+    GObjectClass parent_class;
+};
+
+/**
+ * MyObjectJournalField:
+ * @MY_OBJECT_JOURNAL_VALUE: the value changed
+ * @MY_OBJECT_JOURNAL_NAME: the name changed
+ *
+ * Which field a #MyObjectJournalRecord reports.
+ */
+typedef enum {
+    MY_OBJECT_JOURNAL_VALUE,
+    MY_OBJECT_JOURNAL_NAME
+} MyObjectJournalField;
+
+/**
+ * MyObjectJournalRecord:
+ * @sequence: the position of the record in the journal, counting from 1
+ * @name: (nullable): the new name, for %MY_OBJECT_JOURNAL_NAME records
+ * @object_id: the id my_object_journal_add() gave the object
+ * @field: the field that changed
+ * @value: the new value, for %MY_OBJECT_JOURNAL_VALUE records
+ *
+ * One change appended to a #MyObjectJournal. @name is a #GRefString held
+ * by the record, see my_object_journal_clear_records().
+ */
+typedef struct {
+    guint64 sequence;
+    gchar *name;
+    guint object_id;
+    MyObjectJournalField field;
+    gint value;
+} MyObjectJournalRecord;
+
+MY_OBJECT_EXPORT
+GType my_object_journal_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectJournal *my_object_journal_new (guint capacity);
+
+/* Membership */
+MY_OBJECT_EXPORT
+guint my_object_journal_add (MyObjectJournal *self, MyObject *object);
+MY_OBJECT_EXPORT
+gboolean my_object_journal_remove (MyObjectJournal *self, MyObject *object);
+
+/* Reading */
+MY_OBJECT_EXPORT
+guint64 my_object_journal_get_next_sequence (MyObjectJournal *self);
+MY_OBJECT_EXPORT
+guint my_object_journal_read (MyObjectJournal       *self,
+                              guint64               *sequence,
+                              MyObjectJournalRecord *records,
+                              guint                  n_records);
+MY_OBJECT_EXPORT
+void my_object_journal_clear_records (MyObjectJournalRecord *records,
+                                      guint                  n_records);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_JOURNAL_H */
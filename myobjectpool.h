@@ -0,0 +1,46 @@
+#ifndef MY_OBJECT_POOL_H
+#define MY_OBJECT_POOL_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_POOL (my_object_pool_get_type())
+#define MY_OBJECT_POOL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_POOL, MyObjectPool))
+#define MY_OBJECT_POOL_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_POOL, MyObjectPoolClass))
+#define MY_IS_OBJECT_POOL(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_POOL))
+#define MY_IS_OBJECT_POOL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_POOL))
+#define MY_OBJECT_POOL_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_POOL, MyObjectPoolClass))
+
+typedef struct _MyObjectPool MyObjectPool;
+typedef struct _MyObjectPoolClass MyObjectPoolClass;
+
+/**
+ * MyObjectPoolClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectPool.
+ */
+struct _MyObjectPoolClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_pool_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectPool *my_object_pool_new (guint n_preallocated);
+
+/* Methods */
+MY_OBJECT_EXPORT
+MyObject *my_object_pool_acquire (MyObjectPool *self, gint value);
+MY_OBJECT_EXPORT
+void my_object_pool_release (MyObjectPool *self, MyObject *object);
+MY_OBJECT_EXPORT
+guint my_object_pool_get_n_idle (MyObjectPool *self);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_POOL_H */
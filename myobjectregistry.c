@@ -0,0 +1,514 @@
+#include "myobjectregistry.h"
+#include "myobject-private.h"
+#include <string.h>
+
+/**
+ * SECTION:myobjectregistry
+ * @short_description: Finds objects by name
+ * @title: MyObjectRegistry
+ * @stability: Unstable
+ * @include: myobjectregistry.h
+ *
+ * MyObjectRegistry indexes a set of #MyObject instances by their name and
+ * keeps the index current by itself: my_object_set_name() on a member
+ * moves it to its new name through an internal hook, before
+ * #GObject::notify is emitted, so there is nothing to keep in sync.
+ *
+ * Each registry interns the names of its members in a table of its own.
+ * An interned name is shared by the members that have it and freed with
+ * the last of them, so generated or recycled names cost nothing once no
+ * member carries them, unlike quarks, which live as long as the process.
+ * The index compares and hashes interned names by pointer, and a lookup
+ * for a name that no member has is rejected by the intern table without
+ * touching the index. The index is an open-addressed table with
+ * robin-hood displacement, which keeps probe sequences short even at
+ * high load.
+ *
+ * The registry does not keep its members alive. It holds a weak
+ * reference on each, and an object being finalized leaves the index
+ * before its memory is released. Several members may share a name. A
+ * registry must only be used from one thread at a time, the one that
+ * changes its members' names and drops their last references.
+ */
+
+/* Grow when more than 7/8 of the slots are used */
+#define REGISTRY_MIN_BITS 4
+#define REGISTRY_MAX_LOAD(capacity) ((capacity) / 8 * 7)
+
+/* An interned name; keys are pointers to str */
+typedef struct {
+    guint ref_count;            /* members indexed under this name */
+    guint32 hash;
+    gchar str[];
+} MyObjectRegistryName;
+
+typedef struct {
+    MyObjectRegistry *registry;
+    MyObject *object;
+    const gchar *key;           /* name the object is indexed under, or NULL */
+} MyObjectRegistryMember;
+
+/* An index slot, empty when key is NULL */
+typedef struct {
+    const gchar *key;
+    guint32 hash;
+    MyObject *object;
+} MyObjectRegistrySlot;
+
+/**
+ * MyObjectRegistry:
+ *
+ * An index of #MyObject instances by name.
+ */
+struct _MyObjectRegistry {
+    GObject parent_instance;
+    
+    MyObjectRegistrySlot *slots;    /* NULL until the first named member */
+    guint bits;                     /* capacity is 1 << bits */
+    guint n_used;
+    GHashTable *names;              /* string -> MyObjectRegistryName */
+    GHashTable *members;            /* MyObject -> MyObjectRegistryMember */
+};
+
+G_DEFINE_TYPE (MyObjectRegistry, my_object_registry, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_registry_finalize (GObject *object);
+
+static inline MyObjectRegistryName *
+registry_name_from_key (const gchar *key)
+{
+    return (MyObjectRegistryName *) (key - G_STRUCT_OFFSET (MyObjectRegistryName, str));
+}
+
+/* Returns the interned copy of @str, or NULL if no member has that name */
+static const gchar *
+registry_key_lookup (MyObjectRegistry *self, const gchar *str)
+{
+    MyObjectRegistryName *name = g_hash_table_lookup (self->names, str);
+    
+    return name ? name->str : NULL;
+}
+
+/* Interns @str, or takes another reference on its interned copy */
+static const gchar *
+registry_key_acquire (MyObjectRegistry *self, const gchar *str)
+{
+    MyObjectRegistryName *name = g_hash_table_lookup (self->names, str);
+    
+    if (!name) {
+        gsize len = strlen (str);
+        
+        name = g_malloc (G_STRUCT_OFFSET (MyObjectRegistryName, str) + len + 1);
+        name->ref_count = 0;
+        /* Fibonacci hashing; the home slot takes the top bits */
+        name->hash = g_str_hash (str) * 2654435769u;
+        memcpy (name->str, str, len + 1);
+        g_hash_table_insert (self->names, name->str, name);
+    }
+    
+    name->ref_count++;
+    
+    return name->str;
+}
+
+/* Drops a reference on an interned name, freeing it with the last one */
+static void
+registry_key_release (MyObjectRegistry *self, const gchar *key)
+{
+    if (--registry_name_from_key (key)->ref_count == 0)
+        g_hash_table_remove (self->names, key);
+}
+
+static inline guint32
+registry_hash (const gchar *key)
+{
+    return registry_name_from_key (key)->hash;
+}
+
+static inline guint
+registry_home (MyObjectRegistry *self, guint32 hash)
+{
+    return hash >> (32 - self->bits);
+}
+
+/* How far the entry in @slot is from its home slot */
+static inline guint
+registry_distance (MyObjectRegistry *self, guint slot)
+{
+    guint mask = (1u << self->bits) - 1;
+    
+    return (slot - registry_home (self, self->slots[slot].hash)) & mask;
+}
+
+static void registry_insert (MyObjectRegistry *self, const gchar *key, MyObject *object);
+
+static void
+registry_grow (MyObjectRegistry *self)
+{
+    MyObjectRegistrySlot *old_slots = self->slots;
+    guint old_capacity = old_slots ? 1u << self->bits : 0;
+    guint i;
+    
+    self->bits = old_slots ? self->bits + 1 : REGISTRY_MIN_BITS;
+    self->slots = g_new0 (MyObjectRegistrySlot, 1u << self->bits);
+    self->n_used = 0;
+    
+    for (i = 0; i < old_capacity; i++) {
+        if (old_slots[i].key)
+            registry_insert (self, old_slots[i].key, old_slots[i].object);
+    }
+    
+    g_free (old_slots);
+}
+
+/* Robin hood insertion: an entry further from home than the one it meets
+ * takes that slot, and the displaced entry continues the probe */
+static void
+registry_insert (MyObjectRegistry *self, const gchar *key, MyObject *object)
+{
+    MyObjectRegistrySlot entry = { key, registry_hash (key), object };
+    guint mask, slot, distance = 0;
+    
+    if (!self->slots || self->n_used + 1 > REGISTRY_MAX_LOAD (1u << self->bits))
+        registry_grow (self);
+    
+    mask = (1u << self->bits) - 1;
+    slot = registry_home (self, entry.hash);
+    
+    while (self->slots[slot].key) {
+        guint resident = registry_distance (self, slot);
+        
+        if (resident < distance) {
+            MyObjectRegistrySlot displaced = self->slots[slot];
+            
+            self->slots[slot] = entry;
+            entry = displaced;
+            distance = resident;
+        }
+        
+        slot = (slot + 1) & mask;
+        distance++;
+    }
+    
+    self->slots[slot] = entry;
+    self->n_used++;
+}
+
+/* Calls @func on each slot holding @key until it returns TRUE, and
+ * returns that slot or -1. The probe stops at the first entry closer to
+ * its home than the probe is to @key's, where @key would have been
+ * placed. */
+typedef gboolean (*RegistryMatchFunc) (MyObjectRegistrySlot *slot, gpointer data);
+
+static gint
+registry_find (MyObjectRegistry *self,
+               const gchar      *key,
+               RegistryMatchFunc func,
+               gpointer          data)
+{
+    guint32 hash = registry_hash (key);
+    guint mask, slot, distance = 0;
+    
+    if (!self->slots)
+        return -1;
+    
+    mask = (1u << self->bits) - 1;
+    slot = registry_home (self, hash);
+    
+    while (self->slots[slot].key && registry_distance (self, slot) >= distance) {
+        if (self->slots[slot].key == key && func (&self->slots[slot], data))
+            return (gint) slot;
+        
+        slot = (slot + 1) & mask;
+        distance++;
+    }
+    
+    return -1;
+}
+
+static gboolean
+registry_match_object (MyObjectRegistrySlot *slot, gpointer data)
+{
+    return slot->object == data;
+}
+
+static gboolean
+registry_match_any (MyObjectRegistrySlot *slot, gpointer data)
+{
+    return TRUE;
+}
+
+static gboolean
+registry_match_collect (MyObjectRegistrySlot *slot, gpointer data)
+{
+    g_ptr_array_add (data, g_object_ref (slot->object));
+    
+    return FALSE;
+}
+
+/* Backward-shift deletion: following entries that are not at home move
+ * back one slot, so no tombstones are needed */
+static void
+registry_remove (MyObjectRegistry *self, const gchar *key, MyObject *object)
+{
+    gint found = registry_find (self, key, registry_match_object, object);
+    guint mask, slot, next;
+    
+    g_return_if_fail (found >= 0);
+    
+    mask = (1u << self->bits) - 1;
+    slot = (guint) found;
+    next = (slot + 1) & mask;
+    
+    while (self->slots[next].key && registry_distance (self, next) > 0) {
+        self->slots[slot] = self->slots[next];
+        slot = next;
+        next = (next + 1) & mask;
+    }
+    
+    memset (&self->slots[slot], 0, sizeof self->slots[slot]);
+    self->n_used--;
+}
+
+/* Name hook of every member */
+static void
+my_object_registry_member_renamed (MyObject *object, gpointer data)
+{
+    MyObjectRegistryMember *member = data;
+    MyObjectRegistry *self = member->registry;
+    const gchar *name = my_object_get_name (object);
+    
+    if (g_strcmp0 (name, member->key) == 0)
+        return;
+    
+    if (member->key) {
+        registry_remove (self, member->key, object);
+        registry_key_release (self, member->key);
+    }
+    
+    member->key = name ? registry_key_acquire (self, name) : NULL;
+    if (member->key)
+        registry_insert (self, member->key, object);
+}
+
+/* Unindexes and frees @member; its object is still alive */
+static void
+my_object_registry_member_forget (MyObjectRegistryMember *member)
+{
+    if (member->key) {
+        registry_remove (member->registry, member->key, member->object);
+        registry_key_release (member->registry, member->key);
+    }
+    my_object_remove_name_hook (member->object,
+                                my_object_registry_member_renamed, member);
+    g_free (member);
+}
+
+/* Runs while the object is disposed, before it is finalized */
+static void
+my_object_registry_member_disposed (gpointer data, GObject *where_the_object_was)
+{
+    MyObjectRegistryMember *member = data;
+    
+    g_hash_table_remove (member->registry->members, member->object);
+    my_object_registry_member_forget (member);
+}
+
+/* Class initialization */
+static void
+my_object_registry_class_init (MyObjectRegistryClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_registry_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_registry_init (MyObjectRegistry *self)
+{
+    self->slots = NULL;
+    self->bits = 0;
+    self->n_used = 0;
+    self->names = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+    self->members = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_registry_finalize (GObject *object)
+{
+    MyObjectRegistry *self = MY_OBJECT_REGISTRY (object);
+    GHashTableIter iter;
+    gpointer member;
+    
+    g_hash_table_iter_init (&iter, self->members);
+    while (g_hash_table_iter_next (&iter, NULL, &member)) {
+        g_object_weak_unref (G_OBJECT (((MyObjectRegistryMember *) member)->object),
+                             my_object_registry_member_disposed, member);
+        my_object_registry_member_forget (member);
+    }
+    
+    g_hash_table_unref (self->members);
+    g_hash_table_unref (self->names);
+    g_free (self->slots);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_registry_parent_class)->finalize (object);
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_registry_new:
+ *
+ * Creates a new, empty #MyObjectRegistry.
+ *
+ * Returns: (transfer full): a new #MyObjectRegistry
+ */
+MyObjectRegistry *
+my_object_registry_new (void)
+{
+    return g_object_new (MY_TYPE_OBJECT_REGISTRY, NULL);
+}
+
+/**
+ * my_object_registry_add:
+ * @self: a #MyObjectRegistry
+ * @object: the #MyObject to index
+ *
+ * Adds @object to the registry, under its current name if it has one and
+ * under every name it is given later, until it is removed or finalized.
+ * The registry does not take a reference on @object.
+ *
+ * Returns: %TRUE if @object was added, %FALSE if it already was a member
+ */
+gboolean
+my_object_registry_add (MyObjectRegistry *self, MyObject *object)
+{
+    MyObjectRegistryMember *member;
+    const gchar *name;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_REGISTRY (self), FALSE);
+    g_return_val_if_fail (MY_IS_OBJECT (object), FALSE);
+    
+    if (g_hash_table_contains (self->members, object))
+        return FALSE;
+    
+    name = my_object_get_name (object);
+    member = g_new (MyObjectRegistryMember, 1);
+    member->registry = self;
+    member->object = object;
+    member->key = name ? registry_key_acquire (self, name) : NULL;
+    
+    if (member->key)
+        registry_insert (self, member->key, object);
+    
+    g_hash_table_insert (self->members, object, member);
+    my_object_add_name_hook (object, my_object_registry_member_renamed, member);
+    g_object_weak_ref (G_OBJECT (object), my_object_registry_member_disposed, member);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_registry_remove:
+ * @self: a #MyObjectRegistry
+ * @object: the #MyObject to forget
+ *
+ * Removes @object from the registry.
+ *
+ * Returns: %TRUE if @object was removed, %FALSE if it was not a member
+ */
+gboolean
+my_object_registry_remove (MyObjectRegistry *self, MyObject *object)
+{
+    MyObjectRegistryMember *member;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_REGISTRY (self), FALSE);
+    g_return_val_if_fail (MY_IS_OBJECT (object), FALSE);
+    
+    member = g_hash_table_lookup (self->members, object);
+    if (!member)
+        return FALSE;
+    
+    g_hash_table_remove (self->members, object);
+    g_object_weak_unref (G_OBJECT (object), my_object_registry_member_disposed, member);
+    my_object_registry_member_forget (member);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_registry_get_size:
+ * @self: a #MyObjectRegistry
+ *
+ * Gets the number of members, named or not.
+ *
+ * Returns: the number of objects in the registry
+ */
+guint
+my_object_registry_get_size (MyObjectRegistry *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_REGISTRY (self), 0);
+    
+    return g_hash_table_size (self->members);
+}
+
+/**
+ * my_object_registry_lookup:
+ * @self: a #MyObjectRegistry
+ * @name: the name to look for
+ *
+ * Finds a member named @name. When several members have that name, any
+ * one of them may be returned; use my_object_registry_lookup_all() to
+ * get them all.
+ *
+ * Returns: (transfer none) (nullable): a member named @name, or %NULL
+ */
+MyObject *
+my_object_registry_lookup (MyObjectRegistry *self, const gchar *name)
+{
+    const gchar *key;
+    gint slot;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_REGISTRY (self), NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+    
+    /* A name that is not interned is not the name of any member */
+    key = registry_key_lookup (self, name);
+    if (!key)
+        return NULL;
+    
+    slot = registry_find (self, key, registry_match_any, NULL);
+    
+    return slot >= 0 ? self->slots[slot].object : NULL;
+}
+
+/**
+ * my_object_registry_lookup_all:
+ * @self: a #MyObjectRegistry
+ * @name: the name to look for
+ *
+ * Finds every member named @name, in no particular order.
+ *
+ * Returns: (transfer full) (element-type MyObject): the members named
+ *   @name, possibly none
+ */
+GPtrArray *
+my_object_registry_lookup_all (MyObjectRegistry *self, const gchar *name)
+{
+    GPtrArray *found;
+    const gchar *key;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_REGISTRY (self), NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+    
+    found = g_ptr_array_new_with_free_func (g_object_unref);
+    key = registry_key_lookup (self, name);
+    if (key)
+        registry_find (self, key, registry_match_collect, found);
+    
+    return found;
+}
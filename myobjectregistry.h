@@ -0,0 +1,52 @@
+#ifndef MY_OBJECT_REGISTRY_H
+#define MY_OBJECT_REGISTRY_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_REGISTRY (my_object_registry_get_type())
+#define MY_OBJECT_REGISTRY(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_REGISTRY, MyObjectRegistry))
+#define MY_OBJECT_REGISTRY_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_REGISTRY, MyObjectRegistryClass))
+#define MY_IS_OBJECT_REGISTRY(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_REGISTRY))
+#define MY_IS_OBJECT_REGISTRY_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_REGISTRY))
+#define MY_OBJECT_REGISTRY_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_REGISTRY, MyObjectRegistryClass))
+
+typedef struct _MyObjectRegistry MyObjectRegistry;
+typedef struct _MyObjectRegistryClass MyObjectRegistryClass;
+
+/**
+ * MyObjectRegistryClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectRegistry.
+ */
+struct _MyObjectRegistryClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_registry_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectRegistry *my_object_registry_new (void);
+
+/* Membership */
+MY_OBJECT_EXPORT
+gboolean my_object_registry_add (MyObjectRegistry *self, MyObject *object);
+MY_OBJECT_EXPORT
+gboolean my_object_registry_remove (MyObjectRegistry *self, MyObject *object);
+MY_OBJECT_EXPORT
+guint my_object_registry_get_size (MyObjectRegistry *self);
+
+/* Lookup */
+MY_OBJECT_EXPORT
+MyObject *my_object_registry_lookup (MyObjectRegistry *self, const gchar *name);
+MY_OBJECT_EXPORT
+GPtrArray *my_object_registry_lookup_all (MyObjectRegistry *self, const gchar *name);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_REGISTRY_H */
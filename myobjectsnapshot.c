@@ -0,0 +1,168 @@
+#include "myobjectsnapshot.h"
+#include "myobject-private.h"
+#include <string.h>
+
+/**
+ * SECTION:myobjectsnapshot
+ * @short_description: Immutable point-in-time copies of objects
+ * @title: MyObjectSnapshot
+ * @stability: Unstable
+ * @include: myobjectsnapshot.h
+ *
+ * my_object_snapshot() records the value and name of a #MyObject in a
+ * small reference-counted record that never changes afterwards. Once
+ * taken, a snapshot may be read and shared from any thread without
+ * locking, while the object goes on changing.
+ *
+ * Taking a snapshot costs one allocation and does not copy the name:
+ * names on the heap are #GRefString buffers shared with the object, and
+ * names in an arena keep the arena alive. Only short names, which the
+ * object stores inside itself, are copied into the snapshot.
+ *
+ * The snapshot must be taken on a thread that may read the object, like
+ * any other getter.
+ */
+
+/**
+ * MyObjectSnapshot:
+ *
+ * An immutable copy of the value and name of a #MyObject.
+ */
+struct _MyObjectSnapshot {
+    gint ref_count;
+    gint value;
+    const gchar *name;
+    gchar *name_ref;            /* GRefString behind name, if any */
+    MyNameArena *name_arena;    /* arena behind name, if any */
+    gchar name_inline[NAME_INLINE_SIZE];
+};
+
+G_DEFINE_BOXED_TYPE (MyObjectSnapshot, my_object_snapshot,
+                     my_object_snapshot_ref, my_object_snapshot_unref)
+
+/**
+ * my_object_snapshot:
+ * @object: a #MyObject
+ *
+ * Takes a snapshot of the current value and name of @object.
+ *
+ * Returns: (transfer full): a new #MyObjectSnapshot, release it with
+ *   my_object_snapshot_unref()
+ */
+MyObjectSnapshot *
+my_object_snapshot (MyObject *object)
+{
+    MyObjectSnapshot *self;
+    
+    g_return_val_if_fail (MY_IS_OBJECT (object), NULL);
+    
+    self = g_new (MyObjectSnapshot, 1);
+    self->ref_count = 1;
+    self->value = my_object_get_value (object);
+    
+    if (!my_object_share_name (object, &self->name, &self->name_ref, &self->name_arena)) {
+        /* Stored inline by the object, so it fits inline here too */
+        strcpy (self->name_inline, self->name);
+        self->name = self->name_inline;
+    }
+    
+    return self;
+}
+
+/**
+ * my_object_snapshot_ref:
+ * @self: a #MyObjectSnapshot
+ *
+ * Acquires a reference on @self. This is safe from any thread.
+ *
+ * Returns: (transfer full): @self
+ */
+MyObjectSnapshot *
+my_object_snapshot_ref (MyObjectSnapshot *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+    
+    g_atomic_int_inc (&self->ref_count);
+    
+    return self;
+}
+
+/**
+ * my_object_snapshot_unref:
+ * @self: (transfer full): a #MyObjectSnapshot
+ *
+ * Releases a reference on @self, freeing it when it was the last one.
+ * This is safe from any thread.
+ */
+void
+my_object_snapshot_unref (MyObjectSnapshot *self)
+{
+    g_return_if_fail (self != NULL);
+    
+    if (!g_atomic_int_dec_and_test (&self->ref_count))
+        return;
+    
+    if (self->name_ref)
+        g_ref_string_release (self->name_ref);
+    if (self->name_arena)
+        my_name_arena_unref (self->name_arena);
+    g_free (self);
+}
+
+/**
+ * my_object_snapshot_get_value:
+ * @self: a #MyObjectSnapshot
+ *
+ * Gets the value the object had when the snapshot was taken.
+ *
+ * Returns: the value
+ */
+gint
+my_object_snapshot_get_value (MyObjectSnapshot *self)
+{
+    g_return_val_if_fail (self != NULL, 0);
+    
+    return self->value;
+}
+
+/**
+ * my_object_snapshot_get_name:
+ * @self: a #MyObjectSnapshot
+ *
+ * Gets the name the object had when the snapshot was taken. The string
+ * is valid for as long as @self is.
+ *
+ * Returns: (nullable): the name or %NULL
+ */
+const gchar *
+my_object_snapshot_get_name (MyObjectSnapshot *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+    
+    return self->name;
+}
+
+/**
+ * my_object_snapshot_to_string:
+ * @self: a #MyObjectSnapshot
+ *
+ * Formats @self the way my_object_to_string() formats the object it was
+ * taken from.
+ *
+ * Returns: (transfer full): a newly allocated string
+ */
+gchar *
+my_object_snapshot_to_string (MyObjectSnapshot *self)
+{
+    gchar *str;
+    gsize len;
+    
+    g_return_val_if_fail (self != NULL, NULL);
+    
+    len = my_object_format_parts ("MyObject", self->name, self->value, NULL, 0);
+    str = g_malloc (len + 1);
+    my_object_format_parts ("MyObject", self->name, self->value, str, len);
+    str[len] = '\0';
+    
+    return str;
+}
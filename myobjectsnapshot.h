@@ -0,0 +1,36 @@
+#ifndef MY_OBJECT_SNAPSHOT_H
+#define MY_OBJECT_SNAPSHOT_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_SNAPSHOT (my_object_snapshot_get_type())
+
+typedef struct _MyObjectSnapshot MyObjectSnapshot;
+
+MY_OBJECT_EXPORT
+GType my_object_snapshot_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectSnapshot *my_object_snapshot (MyObject *object);
+
+/* Reference counting */
+MY_OBJECT_EXPORT
+MyObjectSnapshot *my_object_snapshot_ref (MyObjectSnapshot *self);
+MY_OBJECT_EXPORT
+void my_object_snapshot_unref (MyObjectSnapshot *self);
+
+/* Accessors */
+MY_OBJECT_EXPORT
+gint my_object_snapshot_get_value (MyObjectSnapshot *self);
+MY_OBJECT_EXPORT
+const gchar *my_object_snapshot_get_name (MyObjectSnapshot *self);
+MY_OBJECT_EXPORT
+gchar *my_object_snapshot_to_string (MyObjectSnapshot *self);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_SNAPSHOT_H */
@@ -0,0 +1,752 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "myobjectstore.h"
+#include "myobject-private.h"
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * SECTION:myobjectstore
+ * @short_description: A persistent, memory-mapped collection of MyObject records
+ * @title: MyObjectStore
+ * @stability: Unstable
+ * @include: myobjectstore.h
+ *
+ * MyObjectStore keeps the values and names of a fixed number of records
+ * in a file mapped with MAP_SHARED. The file uses the record table layout
+ * described for #MyObjectTable, with spare room for records and names, so
+ * a closed store can also be read with my_object_table_new_from_file().
+ *
+ * Opening a store maps the file and validates its header without reading
+ * the records, so reopening a store of ten million records takes about
+ * as long as reopening an empty one. Values are read and written in the
+ * mapping; my_object_store_get_object() returns a #MyObject view whose
+ * value is the mapped slot itself and whose name changes are written to
+ * the file.
+ *
+ * Names are kept in a string heap at the end of the file. A new name
+ * that is no longer than the one it replaces overwrites it; a longer one
+ * is appended, and once the heap is full the names are compacted to
+ * reclaim the bytes of replaced names. Compaction moves one name at a
+ * time into bytes no record uses, through the free end of the heap when
+ * a name would overlap its new place, and switches the record to the
+ * copy once it is complete, so a crash during it never garbles a name.
+ * Appends and renames fail with %MY_OBJECT_ERROR_NO_SPACE once the
+ * record capacity is exhausted, or when the live names leave no room for
+ * the new one or the free end of the heap is too small to compact it
+ * safely. Renaming
+ * a view with my_object_set_name() then leaves the view's name unchanged,
+ * and the next my_object_store_sync() reports the error.
+ *
+ * Changes reach the file as the kernel writes back the mapping; call
+ * my_object_store_sync() to wait for that. A store file must only be
+ * opened by one #MyObjectStore at a time, and a store must only be used
+ * from one thread at a time. Stores are available on little-endian Unix
+ * systems.
+ */
+
+/**
+ * MyObjectStore:
+ *
+ * A file-backed collection of #MyObject records.
+ */
+struct _MyObjectStore {
+    GObject parent_instance;
+    
+    gchar *filename;
+    gint fd;
+    guint8 *map;
+    gsize map_size;
+    
+    /* Host-order copy of the header, written back after each change */
+    MyObjectTableHeader header;
+    gint *values;
+    guint32 *name_offsets;
+    gchar *heap;
+    gsize heap_capacity;
+    
+    /* First view rename refused since the last my_object_store_sync() */
+    GError *rename_error;
+    
+    /* Live views indexed like @values, allocated on first use */
+    MyObject **views;
+    guint n_views;
+};
+
+G_DEFINE_TYPE (MyObjectStore, my_object_store, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_store_finalize (GObject *object);
+
+/* Class initialization */
+static void
+my_object_store_class_init (MyObjectStoreClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_store_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_store_init (MyObjectStore *self)
+{
+    self->fd = -1;
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_store_finalize (GObject *object)
+{
+    MyObjectStore *self = MY_OBJECT_STORE (object);
+    
+    /* Views keep the store alive, so none can be left at this point */
+#ifdef G_OS_UNIX
+    if (self->map)
+        munmap (self->map, self->map_size);
+    if (self->fd >= 0)
+        close (self->fd);
+#endif
+    g_clear_error (&self->rename_error);
+    g_free (self->views);
+    g_free (self->filename);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_store_parent_class)->finalize (object);
+}
+
+/* Reports a failed system call on the store's file */
+static void
+my_object_store_set_errno (GError     **error,
+                           gint         saved_errno,
+                           const gchar *operation,
+                           const gchar *filename)
+{
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+                 "Failed to %s %s: %s", operation, filename,
+                 g_strerror (saved_errno));
+}
+
+/* Writes the header back into the mapping */
+static void
+my_object_store_flush_header (MyObjectStore *self)
+{
+    my_object_table_header_write (&self->header, self->map);
+}
+
+/* Maps @fd and takes ownership of it. With @initialize the file is
+ * sized and given an empty table, otherwise it must already hold one.
+ * Returns NULL and closes @fd on error. */
+static MyObjectStore *
+my_object_store_map (gint         fd,
+                     const gchar *filename,
+                     gboolean     initialize,
+                     guint        capacity,
+                     gsize        heap_capacity,
+                     GError     **error)
+{
+#if defined(G_OS_UNIX) && G_BYTE_ORDER == G_LITTLE_ENDIAN
+    MyObjectStore *self;
+    MyObjectTableHeader header;
+    struct stat st;
+    gsize size;
+    void *map;
+    
+    if (initialize) {
+        header.version = MY_OBJECT_TABLE_VERSION;
+        header.header_size = sizeof (MyObjectTableHeader);
+        header.n_records = 0;
+        header.capacity = capacity;
+        header.heap_offset = header.header_size + (guint64) capacity * 8;
+        header.heap_size = 0;
+        size = header.heap_offset + heap_capacity;
+        
+        if (ftruncate (fd, (off_t) size) != 0) {
+            my_object_store_set_errno (error, errno, "resize", filename);
+            close (fd);
+            return NULL;
+        }
+    } else {
+        if (fstat (fd, &st) != 0) {
+            my_object_store_set_errno (error, errno, "stat", filename);
+            close (fd);
+            return NULL;
+        }
+        size = st.st_size;
+    }
+    
+    if (size < sizeof (MyObjectTableHeader)) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                     "%s is not a MyObject store", filename);
+        close (fd);
+        return NULL;
+    }
+    
+    map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        my_object_store_set_errno (error, errno, "map", filename);
+        close (fd);
+        return NULL;
+    }
+    
+    if (initialize) {
+        my_object_table_header_write (&header, map);
+    } else if (!my_object_table_header_read (map, size, &header, error)) {
+        munmap (map, size);
+        close (fd);
+        return NULL;
+    }
+    
+    self = g_object_new (MY_TYPE_OBJECT_STORE, NULL);
+    self->filename = g_strdup (filename);
+    self->fd = fd;
+    self->map = map;
+    self->map_size = size;
+    self->header = header;
+    self->values = (gint *) (self->map + header.header_size);
+    self->name_offsets = (guint32 *) (self->values + header.capacity);
+    self->heap = (gchar *) self->map + header.heap_offset;
+    self->heap_capacity = size - header.heap_offset;
+    
+    return self;
+#else
+    g_set_error_literal (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NOT_SUPPORTED,
+                         "Object stores require a little-endian Unix system");
+#ifdef G_OS_UNIX
+    close (fd);
+#endif
+    return NULL;
+#endif
+}
+
+/* Returns the heap bytes taken by the names of every record but @skip */
+static gsize
+my_object_store_live_size (MyObjectStore *self, guint skip)
+{
+    gsize size = 0;
+    
+    for (guint i = 0; i < self->header.n_records; i++) {
+        const gchar *name = i == skip ? NULL : my_object_store_get_name (self, i);
+        
+        if (name)
+            size += strlen (name) + 1;
+    }
+    
+    return size;
+}
+
+/* Orders record indices by the heap offset of their names */
+static gint
+my_object_store_compare_offsets (gconstpointer a, gconstpointer b, gpointer data)
+{
+    const guint32 *offsets = data;
+    guint32 offset_a = offsets[*(const guint *) a];
+    guint32 offset_b = offsets[*(const guint *) b];
+    
+    return offset_a < offset_b ? -1 : offset_a > offset_b;
+}
+
+/* Packs the names of every record but @skip, which loses its name, at
+ * the start of the heap. Names are moved in heap order into bytes no
+ * record points at, and a record is switched to its copy only once the
+ * copy is complete; a name that overlaps its new place is first parked
+ * at the free end of the heap. Every offset in the file thus points at
+ * an intact name throughout, and the heap only shrinks with the final
+ * header write. Returns FALSE, with nothing changed, when the free end is
+ * too small to park a name that needs it. */
+static gboolean
+my_object_store_compact (MyObjectStore *self, guint skip)
+{
+    gsize limit = MIN (self->heap_capacity, G_MAXUINT32);
+    gsize scratch = self->header.heap_size;
+    GArray *order = g_array_new (FALSE, FALSE, sizeof (guint));
+    gsize end = 0;
+    guint i;
+    
+    for (i = 0; i < self->header.n_records; i++) {
+        if (i != skip && my_object_store_get_name (self, i))
+            g_array_append_val (order, i);
+    }
+    g_array_sort_with_data (order, my_object_store_compare_offsets, self->name_offsets);
+    
+    /* Check every name can be moved before moving any */
+    for (i = 0; i < order->len; i++) {
+        gsize offset = self->name_offsets[g_array_index (order, guint, i)];
+        gsize len = strlen (self->heap + offset) + 1;
+        
+        if (offset > end && end + len > offset && len > limit - scratch) {
+            g_array_unref (order);
+            return FALSE;
+        }
+        end += len;
+    }
+    
+    if (skip < self->header.n_records)
+        self->name_offsets[skip] = MY_OBJECT_TABLE_NO_NAME;
+    
+    for (end = 0, i = 0; i < order->len; i++) {
+        guint index = g_array_index (order, guint, i);
+        gsize offset = self->name_offsets[index];
+        gsize len = strlen (self->heap + offset) + 1;
+        
+        if (offset > end && end + len > offset) {
+            memcpy (self->heap + scratch, self->heap + offset, len);
+            if (self->header.heap_size < scratch + len) {
+                self->header.heap_size = scratch + len;
+                my_object_store_flush_header (self);
+            }
+            self->name_offsets[index] = (guint32) scratch;
+            offset = scratch;
+        }
+        if (offset != end) {
+            memcpy (self->heap + end, self->heap + offset, len);
+            self->name_offsets[index] = (guint32) end;
+        }
+        end += len;
+    }
+    
+    self->header.heap_size = end;
+    my_object_store_flush_header (self);
+    
+    g_array_unref (order);
+    
+    return TRUE;
+}
+
+/* Stores @name for the record at @index. A name that fits in the bytes
+ * of the current name overwrites it; any other is appended, compacting
+ * the heap first when that makes room and can be done safely. The heap size is published before
+ * the offset, so a reader never sees an offset past the end of the heap.
+ * Nothing is changed on error. */
+static gboolean
+my_object_store_write_name (MyObjectStore *self,
+                            guint          index,
+                            const gchar   *name,
+                            GError       **error)
+{
+    gsize limit = MIN (self->heap_capacity, G_MAXUINT32);
+    const gchar *old = NULL;
+    gchar *copy = NULL;
+    guint skip = index;
+    gsize pos, len;
+    
+    if (!name) {
+        self->name_offsets[index] = MY_OBJECT_TABLE_NO_NAME;
+        return TRUE;
+    }
+    
+    /* A new record has no current name */
+    if (index < self->header.n_records)
+        old = my_object_store_get_name (self, index);
+    
+    len = strlen (name) + 1;
+    if (old && len <= strlen (old) + 1) {
+        memmove (self->heap + self->name_offsets[index], name, len);
+        return TRUE;
+    }
+    
+    if (len > limit - self->header.heap_size) {
+        if (len > limit - my_object_store_live_size (self, index)) {
+            g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE,
+                         "Name heap of %s is full", self->filename);
+            return FALSE;
+        }
+        
+        /* @name may be a name about to be moved */
+        if (name >= self->heap && name < self->heap + self->header.heap_size)
+            name = copy = g_strdup (name);
+        
+        /* The old name is kept through compaction when there is room, so
+         * that a crash leaves the record with one of its names */
+        if (old && len <= limit - my_object_store_live_size (self, G_MAXUINT))
+            skip = G_MAXUINT;
+        if (!my_object_store_compact (self, skip)) {
+            g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE,
+                         "Name heap of %s is too full to compact", self->filename);
+            g_free (copy);
+            return FALSE;
+        }
+    }
+    
+    pos = self->header.heap_size;
+    memcpy (self->heap + pos, name, len);
+    
+    self->header.heap_size += len;
+    my_object_store_flush_header (self);
+    self->name_offsets[index] = (guint32) pos;
+    
+    g_free (copy);
+    
+    return TRUE;
+}
+
+/* Detach callback run when a view is finalized */
+static void
+my_object_store_detach_view (GObject *owner, guint index)
+{
+    MyObjectStore *self = MY_OBJECT_STORE (owner);
+    
+    self->views[index] = NULL;
+    self->n_views--;
+}
+
+/* Name callback run before a view is renamed. A name that cannot be
+ * stored is refused, so that the view never disagrees with the file. */
+static gboolean
+my_object_store_view_persist_name (GObject     *owner,
+                                   guint        index,
+                                   const gchar *name)
+{
+    MyObjectStore *self = MY_OBJECT_STORE (owner);
+    GError *error = NULL;
+    
+    /* my_object_store_set_name() already stored it */
+    if (g_strcmp0 (my_object_store_get_name (self, index), name) == 0)
+        return TRUE;
+    
+    if (my_object_store_write_name (self, index, name, &error))
+        return TRUE;
+    
+    if (self->rename_error == NULL)
+        self->rename_error = error;
+    else
+        g_error_free (error);
+    
+    return FALSE;
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_store_create:
+ * @filename: (type filename): the path of the store file
+ * @capacity: the maximum number of records
+ * @heap_capacity: the number of bytes reserved for names
+ * @error: return location for a #GError, or %NULL
+ *
+ * Creates an empty store in @filename, replacing any existing file. The
+ * file is sized for @capacity records and @heap_capacity bytes of
+ * nul-terminated names up front; on most file systems the unused space
+ * does not occupy disk blocks.
+ *
+ * Returns: (transfer full): a new #MyObjectStore, or %NULL on error
+ */
+MyObjectStore *
+my_object_store_create (const gchar *filename,
+                        guint        capacity,
+                        gsize        heap_capacity,
+                        GError     **error)
+{
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+    
+#ifdef G_OS_UNIX
+    gint fd = open (filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    
+    if (fd < 0) {
+        my_object_store_set_errno (error, errno, "create", filename);
+        return NULL;
+    }
+    
+    return my_object_store_map (fd, filename, TRUE, capacity, heap_capacity, error);
+#else
+    return my_object_store_map (-1, filename, TRUE, capacity, heap_capacity, error);
+#endif
+}
+
+/**
+ * my_object_store_open:
+ * @filename: (type filename): the path of the store file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Opens a store created with my_object_store_create(). Only the header
+ * is read; records are accessed through the mapping as they are used.
+ *
+ * Returns: (transfer full): a #MyObjectStore, or %NULL on error
+ */
+MyObjectStore *
+my_object_store_open (const gchar *filename, GError **error)
+{
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+    
+#ifdef G_OS_UNIX
+    gint fd = open (filename, O_RDWR);
+    
+    if (fd < 0) {
+        my_object_store_set_errno (error, errno, "open", filename);
+        return NULL;
+    }
+    
+    return my_object_store_map (fd, filename, FALSE, 0, 0, error);
+#else
+    return my_object_store_map (-1, filename, FALSE, 0, 0, error);
+#endif
+}
+
+/**
+ * my_object_store_append:
+ * @self: a #MyObjectStore
+ * @value: the value of the new record
+ * @name: (nullable): the name of the new record
+ * @index: (out) (optional): return location for the index of the record
+ * @error: return location for a #GError, or %NULL
+ *
+ * Adds a record at the end of the store. Fails with
+ * %MY_OBJECT_ERROR_NO_SPACE when the store is at capacity or @name does
+ * not fit in the heap.
+ *
+ * Returns: %TRUE if the record was added
+ */
+gboolean
+my_object_store_append (MyObjectStore *self,
+                        gint           value,
+                        const gchar   *name,
+                        guint         *index,
+                        GError       **error)
+{
+    guint n;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+    
+    n = self->header.n_records;
+    if (n == self->header.capacity) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE,
+                     "%s is full (%u records)", self->filename, n);
+        return FALSE;
+    }
+    
+    if (!my_object_store_write_name (self, n, name, error))
+        return FALSE;
+    
+    /* Publish the record only once it is complete */
+    self->values[n] = value;
+    self->header.n_records = n + 1;
+    my_object_store_flush_header (self);
+    
+    if (index)
+        *index = n;
+    
+    return TRUE;
+}
+
+/**
+ * my_object_store_get_length:
+ * @self: a #MyObjectStore
+ *
+ * Gets the number of records in the store.
+ *
+ * Returns: the number of records
+ */
+guint
+my_object_store_get_length (MyObjectStore *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), 0);
+    
+    return self->header.n_records;
+}
+
+/**
+ * my_object_store_get_capacity:
+ * @self: a #MyObjectStore
+ *
+ * Gets the maximum number of records the store can hold.
+ *
+ * Returns: the record capacity
+ */
+guint
+my_object_store_get_capacity (MyObjectStore *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), 0);
+    
+    return self->header.capacity;
+}
+
+/**
+ * my_object_store_get_value:
+ * @self: a #MyObjectStore
+ * @index: the index of the record
+ *
+ * Gets the value of the record at @index from the mapping.
+ *
+ * Returns: the value
+ */
+gint
+my_object_store_get_value (MyObjectStore *self, guint index)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), 0);
+    g_return_val_if_fail (index < self->header.n_records, 0);
+    
+    return self->values[index];
+}
+
+/**
+ * my_object_store_set_value:
+ * @self: a #MyObjectStore
+ * @index: the index of the record
+ * @value: the new value
+ *
+ * Sets the value of the record at @index in the mapping. If a view of
+ * the record exists, this is equivalent to calling my_object_set_value()
+ * on it.
+ */
+void
+my_object_store_set_value (MyObjectStore *self, guint index, gint value)
+{
+    g_return_if_fail (MY_IS_OBJECT_STORE (self));
+    g_return_if_fail (index < self->header.n_records);
+    
+    if (self->views && self->views[index])
+        my_object_set_value (self->views[index], value);
+    else
+        self->values[index] = value;
+}
+
+/**
+ * my_object_store_get_name:
+ * @self: a #MyObjectStore
+ * @index: the index of the record
+ *
+ * Gets the name of the record at @index. The string points into the
+ * mapping; it is valid until the next rename or append, which may
+ * overwrite or move it.
+ *
+ * Returns: (nullable): the name, or %NULL if the record has none
+ */
+const gchar *
+my_object_store_get_name (MyObjectStore *self, guint index)
+{
+    guint32 offset;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), NULL);
+    g_return_val_if_fail (index < self->header.n_records, NULL);
+    
+    offset = self->name_offsets[index];
+    if (offset == MY_OBJECT_TABLE_NO_NAME || offset >= self->header.heap_size)
+        return NULL;
+    
+    return self->heap + offset;
+}
+
+/**
+ * my_object_store_set_name:
+ * @self: a #MyObjectStore
+ * @index: the index of the record
+ * @name: (nullable): the new name
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the name of the record at @index. If a view of the record exists,
+ * its name is updated as with my_object_set_name(). Fails with
+ * %MY_OBJECT_ERROR_NO_SPACE, changing neither the record nor the view,
+ * when the heap has no room for @name even after compaction, or too
+ * little free room to compact it safely.
+ *
+ * Returns: %TRUE if the name was stored
+ */
+gboolean
+my_object_store_set_name (MyObjectStore *self,
+                          guint          index,
+                          const gchar   *name,
+                          GError       **error)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), FALSE);
+    g_return_val_if_fail (index < self->header.n_records, FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+    
+    if (g_strcmp0 (my_object_store_get_name (self, index), name) == 0)
+        return TRUE;
+    
+    if (!my_object_store_write_name (self, index, name, error))
+        return FALSE;
+    
+    /* The view finds the name already stored */
+    if (self->views && self->views[index])
+        my_object_set_name (self->views[index], name);
+    
+    return TRUE;
+}
+
+/**
+ * my_object_store_get_object:
+ * @self: a #MyObjectStore
+ * @index: the index of the record
+ *
+ * Gets a #MyObject view of the record at @index. The view's value is the
+ * mapped slot, and renaming the view writes the new name to the store.
+ * Repeated calls return the same view while it is alive. Views keep the
+ * store open and cannot be switched to atomic mode.
+ *
+ * Returns: (transfer full): the view of the record
+ */
+MyObject *
+my_object_store_get_object (MyObjectStore *self, guint index)
+{
+    const gchar *name;
+    MyObject *view;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), NULL);
+    g_return_val_if_fail (index < self->header.n_records, NULL);
+    
+    if (self->views == NULL)
+        self->views = g_new0 (MyObject *, self->header.capacity);
+    
+    if (self->views[index])
+        return g_object_ref (self->views[index]);
+    
+    view = my_object_new ();
+    my_object_attach_storage (view, &self->values[index], G_OBJECT (self),
+                              index, my_object_store_detach_view);
+    
+    /* Load the stored name before the view starts writing names back */
+    name = my_object_store_get_name (self, index);
+    if (name)
+        my_object_set_name (view, name);
+    my_object_attach_name_storage (view, my_object_store_view_persist_name);
+    
+    self->views[index] = view;
+    self->n_views++;
+    
+    return view;
+}
+
+/**
+ * my_object_store_sync:
+ * @self: a #MyObjectStore
+ * @error: return location for a #GError, or %NULL
+ *
+ * Waits until every change made so far has been written to the file.
+ * Also fails, once, with the error of the first view rename the store
+ * refused since the previous call, so that code renaming views with
+ * my_object_set_name() learns about names that were not stored.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean
+my_object_store_sync (MyObjectStore *self, GError **error)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_STORE (self), FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+    
+#ifdef G_OS_UNIX
+    if (msync (self->map, self->map_size, MS_SYNC) != 0) {
+        my_object_store_set_errno (error, errno, "sync", self->filename);
+        return FALSE;
+    }
+#endif
+    
+    if (self->rename_error) {
+        g_propagate_error (error, self->rename_error);
+        self->rename_error = NULL;
+        return FALSE;
+    }
+    
+    return TRUE;
+}
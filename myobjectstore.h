@@ -0,0 +1,73 @@
+#ifndef MY_OBJECT_STORE_H
+#define MY_OBJECT_STORE_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_STORE (my_object_store_get_type())
+#define MY_OBJECT_STORE(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_STORE, MyObjectStore))
+#define MY_OBJECT_STORE_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_STORE, MyObjectStoreClass))
+#define MY_IS_OBJECT_STORE(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_STORE))
+#define MY_IS_OBJECT_STORE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_STORE))
+#define MY_OBJECT_STORE_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_STORE, MyObjectStoreClass))
+
+typedef struct _MyObjectStore MyObjectStore;
+typedef struct _MyObjectStoreClass MyObjectStoreClass;
+
+/**
+ * MyObjectStoreClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectStore.
+ */
+struct _MyObjectStoreClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_store_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectStore *my_object_store_create (const gchar *filename,
+                                       guint        capacity,
+                                       gsize        heap_capacity,
+                                       GError     **error);
+MY_OBJECT_EXPORT
+MyObjectStore *my_object_store_open (const gchar *filename,
+                                     GError     **error);
+
+/* Record access */
+MY_OBJECT_EXPORT
+gboolean my_object_store_append (MyObjectStore *self,
+                                 gint           value,
+                                 const gchar   *name,
+                                 guint         *index,
+                                 GError       **error);
+MY_OBJECT_EXPORT
+guint my_object_store_get_length (MyObjectStore *self);
+MY_OBJECT_EXPORT
+guint my_object_store_get_capacity (MyObjectStore *self);
+MY_OBJECT_EXPORT
+gint my_object_store_get_value (MyObjectStore *self, guint index);
+MY_OBJECT_EXPORT
+void my_object_store_set_value (MyObjectStore *self, guint index, gint value);
+MY_OBJECT_EXPORT
+const gchar *my_object_store_get_name (MyObjectStore *self, guint index);
+MY_OBJECT_EXPORT
+gboolean my_object_store_set_name (MyObjectStore *self,
+                                   guint          index,
+                                   const gchar   *name,
+                                   GError       **error);
+MY_OBJECT_EXPORT
+MyObject *my_object_store_get_object (MyObjectStore *self, guint index);
+
+/* Persistence */
+MY_OBJECT_EXPORT
+gboolean my_object_store_sync (MyObjectStore *self, GError **error);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_STORE_H */
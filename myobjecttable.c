@@ -0,0 +1,490 @@
+#include "myobjecttable.h"
+#include "myobject-private.h"
+#include <string.h>
+
+/**
+ * SECTION:myobjecttable
+ * @short_description: Zero-copy reader for serialized MyObject collections
+ * @title: MyObjectTable
+ * @stability: Unstable
+ * @include: myobjecttable.h
+ *
+ * A record table is the collection counterpart of my_object_serialize():
+ * a versioned, little-endian buffer holding the values of many objects as
+ * one contiguous column, followed by a column of name offsets and a heap
+ * of nul-terminated names. Tables are written with
+ * my_object_table_serialize() or my_object_table_serialize_array().
+ *
+ * MyObjectTable reads such a buffer in place. Opening a table only
+ * validates its header, so it costs the same for ten records as for ten
+ * million, and my_object_table_new_from_file() maps the file instead of
+ * reading it. Values and names are returned straight from the buffer
+ * without allocating per record; #MyObject instances are only created
+ * when my_object_table_get_object() is called.
+ *
+ * Tables are immutable and may be read from several threads at once.
+ */
+
+/**
+ * MyObjectTable:
+ *
+ * A read-only view of a serialized collection of #MyObject records.
+ */
+struct _MyObjectTable {
+    GObject parent_instance;
+    
+    GBytes *bytes;
+    MyObjectTableHeader header;
+    const gint32 *values;
+    const guint32 *name_offsets;
+    const gchar *heap;
+    
+    /* Host-order copy of @values, only needed on big-endian hosts and
+     * made under g_once_init_enter() since readers may race for it */
+    gint *host_values;
+};
+
+G_DEFINE_TYPE (MyObjectTable, my_object_table, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_table_finalize (GObject *object);
+
+/* Class initialization */
+static void
+my_object_table_class_init (MyObjectTableClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_table_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_table_init (MyObjectTable *self)
+{
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_table_finalize (GObject *object)
+{
+    MyObjectTable *self = MY_OBJECT_TABLE (object);
+    
+    g_bytes_unref (self->bytes);
+    g_free (self->host_values);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_table_parent_class)->finalize (object);
+}
+
+/* Header encoding, shared with MyObjectStore */
+
+gboolean
+my_object_table_header_read (const guint8        *data,
+                             gsize                size,
+                             MyObjectTableHeader *header,
+                             GError             **error)
+{
+    guint64 columns_end;
+    
+    if (size < sizeof (MyObjectTableHeader)) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                     "Table is truncated (%" G_GSIZE_FORMAT " bytes)", size);
+        return FALSE;
+    }
+    
+    memcpy (header, data, sizeof (MyObjectTableHeader));
+    
+    if (memcmp (header->magic, MY_OBJECT_TABLE_MAGIC, 4) != 0) {
+        g_set_error_literal (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                             "Not a MyObject record table");
+        return FALSE;
+    }
+    
+    header->version = GUINT16_FROM_LE (header->version);
+    header->header_size = GUINT16_FROM_LE (header->header_size);
+    header->n_records = GUINT32_FROM_LE (header->n_records);
+    header->capacity = GUINT32_FROM_LE (header->capacity);
+    header->heap_offset = GUINT64_FROM_LE (header->heap_offset);
+    header->heap_size = GUINT64_FROM_LE (header->heap_size);
+    
+    if (header->version != MY_OBJECT_TABLE_VERSION) {
+        g_set_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_UNSUPPORTED_VERSION,
+                     "Unsupported table version %u", header->version);
+        return FALSE;
+    }
+    
+    /* 64-bit arithmetic cannot overflow for 32-bit record counts */
+    columns_end = header->header_size + (guint64) header->capacity * 8;
+    
+    if (header->header_size < sizeof (MyObjectTableHeader) ||
+        header->header_size % 4 != 0 ||
+        header->n_records > header->capacity ||
+        columns_end > header->heap_offset ||
+        header->heap_offset > size ||
+        header->heap_size > size - header->heap_offset ||
+        header->heap_size > G_MAXUINT32 ||
+        (header->heap_size > 0 &&
+         data[header->heap_offset + header->heap_size - 1] != '\0')) {
+        g_set_error_literal (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA,
+                             "Table header is inconsistent with its size");
+        return FALSE;
+    }
+    
+    return TRUE;
+}
+
+void
+my_object_table_header_write (const MyObjectTableHeader *header,
+                              guint8                    *data)
+{
+    MyObjectTableHeader le;
+    
+    memcpy (le.magic, MY_OBJECT_TABLE_MAGIC, 4);
+    le.version = GUINT16_TO_LE (header->version);
+    le.header_size = GUINT16_TO_LE (header->header_size);
+    le.n_records = GUINT32_TO_LE (header->n_records);
+    le.capacity = GUINT32_TO_LE (header->capacity);
+    le.heap_offset = GUINT64_TO_LE (header->heap_offset);
+    le.heap_size = GUINT64_TO_LE (header->heap_size);
+    
+    memcpy (data, &le, sizeof le);
+}
+
+/* Allocates a zeroed table buffer for @n records and @heap_size bytes of
+ * names, with the header filled in */
+static guint8 *
+my_object_table_alloc (guint n, gsize heap_size, gsize *size)
+{
+    MyObjectTableHeader header;
+    guint8 *data;
+    
+    header.version = MY_OBJECT_TABLE_VERSION;
+    header.header_size = sizeof (MyObjectTableHeader);
+    header.n_records = n;
+    header.capacity = n;
+    header.heap_offset = header.header_size + (guint64) n * 8;
+    header.heap_size = heap_size;
+    
+    *size = header.heap_offset + heap_size;
+    data = g_malloc0 (*size);
+    my_object_table_header_write (&header, data);
+    
+    return data;
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_table_serialize:
+ * @objects: (array length=n_objects): the objects to write
+ * @n_objects: the number of objects
+ *
+ * Writes the values and names of @objects as a record table that
+ * my_object_table_new() can read, in the order given.
+ *
+ * Returns: (transfer full): the serialized table
+ */
+GBytes *
+my_object_table_serialize (MyObject **objects, guint n_objects)
+{
+    gint32 *values;
+    guint32 *name_offsets;
+    gchar *heap;
+    guint8 *data;
+    gsize heap_size = 0, pos = 0, size;
+    
+    g_return_val_if_fail (objects != NULL || n_objects == 0, NULL);
+    
+    for (guint i = 0; i < n_objects; i++) {
+        const gchar *name;
+        
+        g_return_val_if_fail (MY_IS_OBJECT (objects[i]), NULL);
+        
+        name = my_object_get_name (objects[i]);
+        if (name)
+            heap_size += strlen (name) + 1;
+    }
+    
+    g_return_val_if_fail (heap_size <= G_MAXUINT32, NULL);
+    
+    data = my_object_table_alloc (n_objects, heap_size, &size);
+    values = (gint32 *) (data + sizeof (MyObjectTableHeader));
+    name_offsets = (guint32 *) (values + n_objects);
+    heap = (gchar *) (name_offsets + n_objects);
+    
+    for (guint i = 0; i < n_objects; i++) {
+        const gchar *name = my_object_get_name (objects[i]);
+        
+        values[i] = GINT32_TO_LE (my_object_get_value (objects[i]));
+        
+        if (name) {
+            gsize len = strlen (name) + 1;
+            
+            memcpy (heap + pos, name, len);
+            name_offsets[i] = GUINT32_TO_LE ((guint32) pos);
+            pos += len;
+        } else {
+            name_offsets[i] = GUINT32_TO_LE (MY_OBJECT_TABLE_NO_NAME);
+        }
+    }
+    
+    return g_bytes_new_take (data, size);
+}
+
+/**
+ * my_object_table_serialize_array:
+ * @array: a #MyObjectArray
+ *
+ * Writes the values of @array as a record table without names.
+ *
+ * Returns: (transfer full): the serialized table
+ */
+GBytes *
+my_object_table_serialize_array (MyObjectArray *array)
+{
+    const gint *source;
+    gint32 *values;
+    guint32 *name_offsets;
+    guint8 *data;
+    guint n;
+    gsize size;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_ARRAY (array), NULL);
+    
+    source = my_object_array_get_values (array, &n);
+    data = my_object_table_alloc (n, 0, &size);
+    values = (gint32 *) (data + sizeof (MyObjectTableHeader));
+    name_offsets = (guint32 *) (values + n);
+    
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    if (n > 0)
+        memcpy (values, source, n * sizeof (gint));
+#else
+    for (guint i = 0; i < n; i++)
+        values[i] = GINT32_TO_LE (source[i]);
+#endif
+    memset (name_offsets, 0xff, n * sizeof (guint32));
+    
+    return g_bytes_new_take (data, size);
+}
+
+/**
+ * my_object_table_new:
+ * @bytes: a record table
+ * @error: return location for a #GError, or %NULL
+ *
+ * Opens a record table held in @bytes without copying it. Only the
+ * header is validated; per-record accessors check their bounds as they
+ * go. @bytes is copied once if its data is not suitably aligned.
+ *
+ * Returns: (transfer full): a new #MyObjectTable, or %NULL on error
+ */
+MyObjectTable *
+my_object_table_new (GBytes *bytes, GError **error)
+{
+    MyObjectTable *self;
+    MyObjectTableHeader header;
+    const guint8 *data;
+    gsize size;
+    
+    g_return_val_if_fail (bytes != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+    
+    data = g_bytes_get_data (bytes, &size);
+    if (!my_object_table_header_read (data, size, &header, error))
+        return NULL;
+    
+    self = g_object_new (MY_TYPE_OBJECT_TABLE, NULL);
+    
+    /* The columns are read in place, so they need natural alignment */
+    if (((guintptr) data & (sizeof (gint32) - 1)) != 0) {
+        self->bytes = g_bytes_new (data, size);
+        data = g_bytes_get_data (self->bytes, NULL);
+    } else {
+        self->bytes = g_bytes_ref (bytes);
+    }
+    
+    self->header = header;
+    self->values = (const gint32 *) (data + header.header_size);
+    self->name_offsets = (const guint32 *) (self->values + header.capacity);
+    self->heap = (const gchar *) data + header.heap_offset;
+    
+    return self;
+}
+
+/**
+ * my_object_table_new_from_file:
+ * @filename: (type filename): the path of a record table
+ * @error: return location for a #GError, or %NULL
+ *
+ * Maps the record table stored in @filename and opens it like
+ * my_object_table_new(). The file must not be modified while the table
+ * is alive.
+ *
+ * Returns: (transfer full): a new #MyObjectTable, or %NULL on error
+ */
+MyObjectTable *
+my_object_table_new_from_file (const gchar *filename, GError **error)
+{
+    MyObjectTable *self;
+    GMappedFile *file;
+    GBytes *bytes;
+    
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+    
+    file = g_mapped_file_new (filename, FALSE, error);
+    if (!file)
+        return NULL;
+    
+    bytes = g_mapped_file_get_bytes (file);
+    g_mapped_file_unref (file);
+    
+    self = my_object_table_new (bytes, error);
+    g_bytes_unref (bytes);
+    
+    return self;
+}
+
+/**
+ * my_object_table_get_length:
+ * @self: a #MyObjectTable
+ *
+ * Gets the number of records in the table.
+ *
+ * Returns: the number of records
+ */
+guint
+my_object_table_get_length (MyObjectTable *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), 0);
+    
+    return self->header.n_records;
+}
+
+/**
+ * my_object_table_get_value:
+ * @self: a #MyObjectTable
+ * @index: the index of the record
+ *
+ * Gets the value of the record at @index.
+ *
+ * Returns: the value
+ */
+gint
+my_object_table_get_value (MyObjectTable *self, guint index)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), 0);
+    g_return_val_if_fail (index < self->header.n_records, 0);
+    
+    return GINT32_FROM_LE (self->values[index]);
+}
+
+/**
+ * my_object_table_get_name:
+ * @self: a #MyObjectTable
+ * @index: the index of the record
+ *
+ * Gets the name of the record at @index. The string points into the
+ * table's buffer and stays valid as long as @self.
+ *
+ * Returns: (nullable): the name, or %NULL if the record has none
+ */
+const gchar *
+my_object_table_get_name (MyObjectTable *self, guint index)
+{
+    guint32 offset;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), NULL);
+    g_return_val_if_fail (index < self->header.n_records, NULL);
+    
+    offset = GUINT32_FROM_LE (self->name_offsets[index]);
+    if (offset == MY_OBJECT_TABLE_NO_NAME)
+        return NULL;
+    
+    /* The heap ends with a nul, so any offset inside it is terminated */
+    if (offset >= self->header.heap_size) {
+        g_warning ("Record %u of table %p has an invalid name offset", index, self);
+        return NULL;
+    }
+    
+    return self->heap + offset;
+}
+
+/**
+ * my_object_table_get_values:
+ * @self: a #MyObjectTable
+ * @n_values: (out): return location for the number of values
+ *
+ * Gets the value column of the table, suitable for
+ * my_object_array_new_from_values(). On little-endian hosts this points
+ * into the table's buffer; on big-endian hosts a host-order copy is made
+ * on the first call, exactly once even if several threads make that call
+ * at the same time.
+ *
+ * Returns: (array length=n_values) (transfer none): the values
+ */
+const gint *
+my_object_table_get_values (MyObjectTable *self, guint *n_values)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), NULL);
+    
+    if (n_values)
+        *n_values = self->header.n_records;
+        
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    return (const gint *) self->values;
+#else
+    if (self->header.n_records == 0)
+        return NULL;
+    
+    if (g_once_init_enter (&self->host_values)) {
+        gint *host_values = g_new (gint, self->header.n_records);
+        
+        for (guint i = 0; i < self->header.n_records; i++)
+            host_values[i] = GINT32_FROM_LE (self->values[i]);
+        
+        g_once_init_leave (&self->host_values, host_values);
+    }
+    
+    return self->host_values;
+#endif
+}
+
+/**
+ * my_object_table_get_object:
+ * @self: a #MyObjectTable
+ * @index: the index of the record
+ *
+ * Creates a new #MyObject with the value and name of the record at
+ * @index. The object is independent of the table.
+ *
+ * Returns: (transfer full): a new #MyObject
+ */
+MyObject *
+my_object_table_get_object (MyObjectTable *self, guint index)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), NULL);
+    g_return_val_if_fail (index < self->header.n_records, NULL);
+    
+    return my_object_new_full (my_object_table_get_value (self, index),
+                               my_object_table_get_name (self, index));
+}
+
+/**
+ * my_object_table_get_bytes:
+ * @self: a #MyObjectTable
+ *
+ * Gets the buffer the table reads from, for example to write it to a
+ * file or send it to another process.
+ *
+ * Returns: (transfer none): the table's buffer
+ */
+GBytes *
+my_object_table_get_bytes (MyObjectTable *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TABLE (self), NULL);
+    
+    return self->bytes;
+}
@@ -0,0 +1,62 @@
+#ifndef MY_OBJECT_TABLE_H
+#define MY_OBJECT_TABLE_H
+
+#include <glib-object.h>
+#include "myobject.h"
+#include "myobjectarray.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_TABLE (my_object_table_get_type())
+#define MY_OBJECT_TABLE(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_TABLE, MyObjectTable))
+#define MY_OBJECT_TABLE_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_TABLE, MyObjectTableClass))
+#define MY_IS_OBJECT_TABLE(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_TABLE))
+#define MY_IS_OBJECT_TABLE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_TABLE))
+#define MY_OBJECT_TABLE_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_TABLE, MyObjectTableClass))
+
+typedef struct _MyObjectTable MyObjectTable;
+typedef struct _MyObjectTableClass MyObjectTableClass;
+
+/**
+ * MyObjectTableClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectTable.
+ */
+struct _MyObjectTableClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_table_get_type (void) G_GNUC_CONST;
+
+/* Writing */
+MY_OBJECT_EXPORT
+GBytes *my_object_table_serialize (MyObject **objects, guint n_objects);
+MY_OBJECT_EXPORT
+GBytes *my_object_table_serialize_array (MyObjectArray *array);
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectTable *my_object_table_new (GBytes *bytes, GError **error);
+MY_OBJECT_EXPORT
+MyObjectTable *my_object_table_new_from_file (const gchar *filename,
+                                              GError     **error);
+
+/* Record access */
+MY_OBJECT_EXPORT
+guint my_object_table_get_length (MyObjectTable *self);
+MY_OBJECT_EXPORT
+gint my_object_table_get_value (MyObjectTable *self, guint index);
+MY_OBJECT_EXPORT
+const gchar *my_object_table_get_name (MyObjectTable *self, guint index);
+MY_OBJECT_EXPORT
+const gint *my_object_table_get_values (MyObjectTable *self, guint *n_values);
+MY_OBJECT_EXPORT
+MyObject *my_object_table_get_object (MyObjectTable *self, guint index);
+MY_OBJECT_EXPORT
+GBytes *my_object_table_get_bytes (MyObjectTable *self);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_TABLE_H */
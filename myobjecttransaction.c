@@ -0,0 +1,290 @@
+#include "myobjecttransaction.h"
+
+/**
+ * SECTION:myobjecttransaction
+ * @short_description: Applies changes to many objects at once
+ * @title: MyObjectTransaction
+ * @stability: Unstable
+ * @include: myobjecttransaction.h
+ *
+ * MyObjectTransaction collects changes to the value and name of any
+ * number of #MyObject instances and applies them together with
+ * my_object_transaction_commit(). Nothing is written to the objects
+ * before the commit.
+ *
+ * Writes to the same object are collapsed: only the last value and the
+ * last name recorded for an object are applied. The commit first applies
+ * every change to every object and only then emits notifications, so a
+ * handler connected to one object already sees the new state of all the
+ * others. Each object emits at most one #GObject::notify per property and
+ * one #MyObject::value-changed, and objects are notified in the order in
+ * which the transaction first touched them.
+ *
+ * The commit batches every object with my_object_begin_update(). An
+ * object whose batch cannot be opened on the committing thread, such as
+ * an atomic object whose notify context another thread owns, is not
+ * written; its changes stay in the transaction and
+ * my_object_transaction_commit() returns %FALSE, so that they can be
+ * committed again from a thread that owns the context.
+ *
+ * A transaction holds a reference on every object it touches until it is
+ * committed or cleared. It must only be used from one thread at a time.
+ */
+
+typedef struct {
+    MyObject *object;
+    gboolean has_value;
+    gint value;
+    gboolean has_name;
+    gchar *name;
+} MyObjectTransactionEntry;
+
+/**
+ * MyObjectTransaction:
+ *
+ * A set of pending changes to #MyObject instances.
+ */
+struct _MyObjectTransaction {
+    GObject parent_instance;
+    
+    GArray *entries;        /* MyObjectTransactionEntry, first-touch order */
+    GHashTable *positions;  /* MyObject -> index into entries + 1 */
+};
+
+G_DEFINE_TYPE (MyObjectTransaction, my_object_transaction, G_TYPE_OBJECT)
+
+/* Forward declarations */
+static void my_object_transaction_finalize (GObject *object);
+
+static void
+my_object_transaction_entry_clear (gpointer data)
+{
+    MyObjectTransactionEntry *entry = data;
+    
+    g_clear_object (&entry->object);
+    g_free (entry->name);
+}
+
+static GArray *
+my_object_transaction_entries_new (void)
+{
+    GArray *entries = g_array_new (FALSE, FALSE, sizeof (MyObjectTransactionEntry));
+    
+    g_array_set_clear_func (entries, my_object_transaction_entry_clear);
+    
+    return entries;
+}
+
+/* Class initialization */
+static void
+my_object_transaction_class_init (MyObjectTransactionClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    
+    object_class->finalize = my_object_transaction_finalize;
+}
+
+/* Instance initialization */
+static void
+my_object_transaction_init (MyObjectTransaction *self)
+{
+    self->entries = my_object_transaction_entries_new ();
+    self->positions = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* Finalize method - free allocated memory */
+static void
+my_object_transaction_finalize (GObject *object)
+{
+    MyObjectTransaction *self = MY_OBJECT_TRANSACTION (object);
+    
+    g_array_unref (self->entries);
+    g_hash_table_unref (self->positions);
+    
+    /* Chain up to parent class */
+    G_OBJECT_CLASS (my_object_transaction_parent_class)->finalize (object);
+}
+
+/* Returns the entry for @object, adding one on first touch */
+static MyObjectTransactionEntry *
+my_object_transaction_lookup (MyObjectTransaction *self, MyObject *object)
+{
+    guint position = GPOINTER_TO_UINT (g_hash_table_lookup (self->positions, object));
+    
+    if (position == 0) {
+        MyObjectTransactionEntry entry = { g_object_ref (object), FALSE, 0, FALSE, NULL };
+        
+        g_array_append_val (self->entries, entry);
+        position = self->entries->len;
+        g_hash_table_insert (self->positions, object, GUINT_TO_POINTER (position));
+    }
+    
+    return &g_array_index (self->entries, MyObjectTransactionEntry, position - 1);
+}
+
+/* Moves @entry, taken from a committed set, back into the pending set of
+ * @self and leaves it empty */
+static void
+my_object_transaction_keep (MyObjectTransaction *self, MyObjectTransactionEntry *entry)
+{
+    g_array_append_val (self->entries, *entry);
+    g_hash_table_insert (self->positions, entry->object,
+                         GUINT_TO_POINTER (self->entries->len));
+    entry->object = NULL;
+    entry->name = NULL;
+}
+
+/* Public API implementation */
+
+/**
+ * my_object_transaction_new:
+ *
+ * Creates a new, empty #MyObjectTransaction.
+ *
+ * Returns: (transfer full): a new #MyObjectTransaction
+ */
+MyObjectTransaction *
+my_object_transaction_new (void)
+{
+    return g_object_new (MY_TYPE_OBJECT_TRANSACTION, NULL);
+}
+
+/**
+ * my_object_transaction_set_value:
+ * @self: a #MyObjectTransaction
+ * @object: the #MyObject to change
+ * @value: the new value
+ *
+ * Records that the value of @object is to be set to @value on commit,
+ * replacing any value recorded for @object earlier.
+ */
+void
+my_object_transaction_set_value (MyObjectTransaction *self,
+                                 MyObject            *object,
+                                 gint                 value)
+{
+    MyObjectTransactionEntry *entry;
+    
+    g_return_if_fail (MY_IS_OBJECT_TRANSACTION (self));
+    g_return_if_fail (MY_IS_OBJECT (object));
+    
+    entry = my_object_transaction_lookup (self, object);
+    entry->has_value = TRUE;
+    entry->value = value;
+}
+
+/**
+ * my_object_transaction_set_name:
+ * @self: a #MyObjectTransaction
+ * @object: the #MyObject to change
+ * @name: (nullable): the new name
+ *
+ * Records that the name of @object is to be set to @name on commit,
+ * replacing any name recorded for @object earlier.
+ */
+void
+my_object_transaction_set_name (MyObjectTransaction *self,
+                                MyObject            *object,
+                                const gchar         *name)
+{
+    MyObjectTransactionEntry *entry;
+    
+    g_return_if_fail (MY_IS_OBJECT_TRANSACTION (self));
+    g_return_if_fail (MY_IS_OBJECT (object));
+    
+    entry = my_object_transaction_lookup (self, object);
+    g_free (entry->name);
+    entry->has_name = TRUE;
+    entry->name = g_strdup (name);
+}
+
+/**
+ * my_object_transaction_get_n_objects:
+ * @self: a #MyObjectTransaction
+ *
+ * Gets the number of distinct objects with pending changes.
+ *
+ * Returns: the number of objects the transaction will change
+ */
+guint
+my_object_transaction_get_n_objects (MyObjectTransaction *self)
+{
+    g_return_val_if_fail (MY_IS_OBJECT_TRANSACTION (self), 0);
+    
+    return self->entries->len;
+}
+
+/**
+ * my_object_transaction_commit:
+ * @self: a #MyObjectTransaction
+ *
+ * Applies every pending change, then emits the notifications for all
+ * changed objects in the order in which they were first touched. An
+ * object whose final value equals its current value does not emit
+ * #MyObject::value-changed.
+ *
+ * The transaction is empty afterwards, except for the changes to objects
+ * that could not be batched on this thread, which are left pending and
+ * untouched. Handlers may record and commit new changes on it; they form
+ * a separate transaction, which includes any changes left pending.
+ *
+ * Returns: %TRUE if every change was applied, %FALSE if some were left
+ *   pending
+ */
+gboolean
+my_object_transaction_commit (MyObjectTransaction *self)
+{
+    GArray *entries;
+    gboolean applied = TRUE;
+    guint i;
+    
+    g_return_val_if_fail (MY_IS_OBJECT_TRANSACTION (self), FALSE);
+    
+    /* Take the pending changes, so handlers start from an empty set */
+    entries = self->entries;
+    self->entries = my_object_transaction_entries_new ();
+    g_hash_table_remove_all (self->positions);
+    
+    for (i = 0; i < entries->len; i++) {
+        MyObjectTransactionEntry *entry =
+            &g_array_index (entries, MyObjectTransactionEntry, i);
+        
+        if (!my_object_begin_update (entry->object)) {
+            my_object_transaction_keep (self, entry);
+            applied = FALSE;
+            continue;
+        }
+        if (entry->has_value)
+            my_object_set_value (entry->object, entry->value);
+        if (entry->has_name)
+            my_object_set_name (entry->object, entry->name);
+    }
+    
+    /* Every object is in its final state before the first handler runs */
+    for (i = 0; i < entries->len; i++) {
+        MyObjectTransactionEntry *entry =
+            &g_array_index (entries, MyObjectTransactionEntry, i);
+        
+        if (entry->object)
+            my_object_end_update (entry->object);
+    }
+    
+    g_array_unref (entries);
+    
+    return applied;
+}
+
+/**
+ * my_object_transaction_clear:
+ * @self: a #MyObjectTransaction
+ *
+ * Discards every pending change without touching the objects.
+ */
+void
+my_object_transaction_clear (MyObjectTransaction *self)
+{
+    g_return_if_fail (MY_IS_OBJECT_TRANSACTION (self));
+    
+    g_array_set_size (self->entries, 0);
+    g_hash_table_remove_all (self->positions);
+}
@@ -0,0 +1,54 @@
+#ifndef MY_OBJECT_TRANSACTION_H
+#define MY_OBJECT_TRANSACTION_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_OBJECT_TRANSACTION (my_object_transaction_get_type())
+#define MY_OBJECT_TRANSACTION(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), MY_TYPE_OBJECT_TRANSACTION, MyObjectTransaction))
+#define MY_OBJECT_TRANSACTION_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass), MY_TYPE_OBJECT_TRANSACTION, MyObjectTransactionClass))
+#define MY_IS_OBJECT_TRANSACTION(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), MY_TYPE_OBJECT_TRANSACTION))
+#define MY_IS_OBJECT_TRANSACTION_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), MY_TYPE_OBJECT_TRANSACTION))
+#define MY_OBJECT_TRANSACTION_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), MY_TYPE_OBJECT_TRANSACTION, MyObjectTransactionClass))
+
+typedef struct _MyObjectTransaction MyObjectTransaction;
+typedef struct _MyObjectTransactionClass MyObjectTransactionClass;
+
+/**
+ * MyObjectTransactionClass:
+ * @parent_class: The parent class
+ *
+ * The class structure for MyObjectTransaction.
+ */
+struct _MyObjectTransactionClass {
+    GObjectClass parent_class;
+};
+
+MY_OBJECT_EXPORT
+GType my_object_transaction_get_type (void) G_GNUC_CONST;
+
+/* Constructors */
+MY_OBJECT_EXPORT
+MyObjectTransaction *my_object_transaction_new (void);
+
+/* Methods */
+MY_OBJECT_EXPORT
+void my_object_transaction_set_value (MyObjectTransaction *self,
+                                      MyObject            *object,
+                                      gint                 value);
+MY_OBJECT_EXPORT
+void my_object_transaction_set_name (MyObjectTransaction *self,
+                                     MyObject            *object,
+                                     const gchar         *name);
+MY_OBJECT_EXPORT
+guint my_object_transaction_get_n_objects (MyObjectTransaction *self);
+MY_OBJECT_EXPORT
+gboolean my_object_transaction_commit (MyObjectTransaction *self);
+MY_OBJECT_EXPORT
+void my_object_transaction_clear (MyObjectTransaction *self);
+
+G_END_DECLS
+
+#endif /* MY_OBJECT_TRANSACTION_H */
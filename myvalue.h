@@ -0,0 +1,72 @@
+#ifndef MY_VALUE_H
+#define MY_VALUE_H
+
+#include <glib-object.h>
+#include "myobject.h"
+
+G_BEGIN_DECLS
+
+#define MY_TYPE_VALUE (my_value_get_type())
+
+/**
+ * MyValue:
+ * @value: the integer value
+ * @name: (nullable): the name, owned by the struct; change it with
+ *   my_value_set_name()
+ *
+ * A plain integer and name record with the semantics of #MyObject, but
+ * none of its cost: no type instance, reference count, properties or
+ * signals. A #MyValue can live on the stack or in arrays, in which case
+ * it is set up with my_value_init() and released with my_value_clear().
+ * Convert to a #MyObject with my_value_to_object() when a record needs
+ * to be observed.
+ */
+typedef struct {
+    gint value;
+    gchar *name;
+} MyValue;
+
+MY_OBJECT_EXPORT
+GType my_value_get_type (void) G_GNUC_CONST;
+
+/* Construction */
+MY_OBJECT_EXPORT
+MyValue *my_value_new (gint value, const gchar *name);
+MY_OBJECT_EXPORT
+MyValue *my_value_copy (const MyValue *self);
+MY_OBJECT_EXPORT
+void my_value_free (MyValue *self);
+MY_OBJECT_EXPORT
+void my_value_init (MyValue *self, gint value, const gchar *name);
+MY_OBJECT_EXPORT
+void my_value_clear (MyValue *self);
+
+/* Accessors */
+MY_OBJECT_EXPORT
+void my_value_set_name (MyValue *self, const gchar *name);
+MY_OBJECT_EXPORT
+const gchar *my_value_get_name (const MyValue *self);
+
+/* Methods */
+MY_OBJECT_EXPORT
+void my_value_increment (MyValue *self);
+MY_OBJECT_EXPORT
+void my_value_decrement (MyValue *self);
+MY_OBJECT_EXPORT
+void my_value_add (MyValue *self, gint delta);
+MY_OBJECT_EXPORT
+gchar *my_value_to_string (const MyValue *self);
+MY_OBJECT_EXPORT
+gboolean my_value_equal (const MyValue *a, const MyValue *b);
+
+/* Conversion */
+MY_OBJECT_EXPORT
+MyValue *my_value_new_from_object (MyObject *object);
+MY_OBJECT_EXPORT
+MyObject *my_value_to_object (const MyValue *self);
+MY_OBJECT_EXPORT
+void my_value_apply_to_object (const MyValue *self, MyObject *object);
+
+G_END_DECLS
+
+#endif /* MY_VALUE_H */
@@ -0,0 +1,375 @@
+#include "myobject-private.h"
+
+/*
+ * MyWatchSet: the value watches of one object, see my_object_add_watch().
+ *
+ * Every watch is one or two thresholds in two sorted sequences: "rising"
+ * thresholds fire when the value goes from at or below the threshold to
+ * above it, "falling" thresholds when it goes from at or above to below.
+ * A change from old to new only visits the thresholds that lie between
+ * the two values, found with one binary search, so an update costs
+ * O(log n) plus the watches that fire however many are registered.
+ *
+ * Above and below watches have one fixed threshold. A delta watch has
+ * both, at its reference value plus and minus the delta, and both move
+ * to the new value whenever it fires. Thresholds are 64-bit so that a
+ * reference near the ends of the gint range cannot overflow.
+ *
+ * Watches that fire are collected first and called afterwards, so that
+ * callbacks may add or remove watches, including their own. A removed
+ * watch is skipped if it was still waiting to be called.
+ *
+ * The set also carries the internal hooks of my_object_add_value_hook(),
+ * called on every change before any watch, and of
+ * my_object_add_name_hook(). The sequences are only
+ * created with the first watch, so objects that only have hooks do not
+ * pay for them.
+ */
+
+typedef struct {
+    gint ref_count;
+    guint id;
+    MyWatchKind kind;
+    gint threshold;
+    gint64 reference;           /* delta watches: value at the last firing */
+    MyWatchFunc func;
+    gpointer user_data;
+    GDestroyNotify destroy;
+    GSequenceIter *rising;      /* node in rising, if any */
+    GSequenceIter *falling;     /* node in falling, if any */
+    gboolean removed;
+} MyWatch;
+
+/* A threshold is the sequence key of its watch; ties are broken by id so
+ * that searches can land before or after every equal threshold */
+typedef struct {
+    gint64 threshold;
+    guint id;
+} MyWatchKey;
+
+/* A value or name hook, cast back to its type by the caller */
+typedef struct {
+    GCallback func;
+    gpointer data;
+} MyWatchHook;
+
+struct _MyWatchSet {
+    GSequence *rising;          /* MyWatchKey, sorted; NULL until the first watch */
+    GSequence *falling;         /* MyWatchKey, sorted */
+    GHashTable *by_id;          /* id -> MyWatch */
+    GArray *hooks;              /* MyWatchHook, NULL until the first hook */
+    GArray *name_hooks;         /* MyWatchHook, NULL until the first hook */
+    guint next_id;
+    gint last_value;
+};
+
+static gint
+my_watch_key_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const MyWatchKey *x = a;
+    const MyWatchKey *y = b;
+    
+    if (x->threshold != y->threshold)
+        return x->threshold < y->threshold ? -1 : 1;
+    
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static MyWatch *
+my_watch_ref (MyWatch *watch)
+{
+    watch->ref_count++;
+    
+    return watch;
+}
+
+static void
+my_watch_unref (MyWatch *watch)
+{
+    if (--watch->ref_count > 0)
+        return;
+    
+    if (watch->destroy)
+        watch->destroy (watch->user_data);
+    g_free (watch);
+}
+
+/* Inserts a threshold of @watch into @sequence */
+static GSequenceIter *
+my_watch_set_insert (GSequence *sequence, MyWatch *watch, gint64 threshold)
+{
+    MyWatchKey *key = g_new (MyWatchKey, 1);
+    
+    key->threshold = threshold;
+    key->id = watch->id;
+    
+    return g_sequence_insert_sorted (sequence, key, my_watch_key_compare, NULL);
+}
+
+/* Places the thresholds of a delta watch around @reference */
+static void
+my_watch_set_place_delta (MyWatchSet *set, MyWatch *watch, gint64 reference)
+{
+    g_clear_pointer (&watch->rising, g_sequence_remove);
+    g_clear_pointer (&watch->falling, g_sequence_remove);
+    
+    watch->reference = reference;
+    watch->rising = my_watch_set_insert (set->rising, watch,
+                                         reference + watch->threshold);
+    watch->falling = my_watch_set_insert (set->falling, watch,
+                                          reference - watch->threshold);
+}
+
+MyWatchSet *
+my_watch_set_new (gint value)
+{
+    MyWatchSet *set = g_new0 (MyWatchSet, 1);
+    
+    set->next_id = 1;
+    set->last_value = value;
+    
+    return set;
+}
+
+void
+my_watch_set_free (MyWatchSet *set)
+{
+    my_watch_set_reset (set, set->last_value);
+    
+    if (set->hooks)
+        g_array_unref (set->hooks);
+    if (set->name_hooks)
+        g_array_unref (set->name_hooks);
+    g_free (set);
+}
+
+guint
+my_watch_set_add (MyWatchSet    *set,
+                  MyWatchKind    kind,
+                  gint           threshold,
+                  MyWatchFunc    func,
+                  gpointer       user_data,
+                  GDestroyNotify destroy)
+{
+    MyWatch *watch = g_new0 (MyWatch, 1);
+    
+    if (!set->by_id) {
+        set->rising = g_sequence_new (g_free);
+        set->falling = g_sequence_new (g_free);
+        set->by_id = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify) my_watch_unref);
+    }
+    
+    watch->ref_count = 1;
+    watch->id = set->next_id++;
+    watch->kind = kind;
+    watch->threshold = threshold;
+    watch->func = func;
+    watch->user_data = user_data;
+    watch->destroy = destroy;
+    
+    switch (kind) {
+        case MY_WATCH_ABOVE:
+            watch->rising = my_watch_set_insert (set->rising, watch, threshold);
+            break;
+        case MY_WATCH_BELOW:
+            watch->falling = my_watch_set_insert (set->falling, watch, threshold);
+            break;
+        case MY_WATCH_DELTA:
+            my_watch_set_place_delta (set, watch, set->last_value);
+            break;
+    }
+    
+    g_hash_table_insert (set->by_id, GUINT_TO_POINTER (watch->id), watch);
+    
+    return watch->id;
+}
+
+gboolean
+my_watch_set_remove (MyWatchSet *set, guint id)
+{
+    MyWatch *watch;
+    
+    if (!set->by_id)
+        return FALSE;
+    
+    watch = g_hash_table_lookup (set->by_id, GUINT_TO_POINTER (id));
+    if (!watch)
+        return FALSE;
+    
+    g_clear_pointer (&watch->rising, g_sequence_remove);
+    g_clear_pointer (&watch->falling, g_sequence_remove);
+    watch->removed = TRUE;
+    g_hash_table_remove (set->by_id, GUINT_TO_POINTER (id));
+    
+    return TRUE;
+}
+
+guint
+my_watch_set_get_size (MyWatchSet *set)
+{
+    return set->by_id ? g_hash_table_size (set->by_id) : 0;
+}
+
+void
+my_watch_set_reset (MyWatchSet *set, gint value)
+{
+    if (set->by_id) {
+        /* Watches still waiting to be called keep their own reference */
+        GHashTableIter iter;
+        gpointer watch;
+        
+        g_hash_table_iter_init (&iter, set->by_id);
+        while (g_hash_table_iter_next (&iter, NULL, &watch))
+            ((MyWatch *) watch)->removed = TRUE;
+        
+        g_clear_pointer (&set->by_id, g_hash_table_unref);
+        g_clear_pointer (&set->rising, g_sequence_free);
+        g_clear_pointer (&set->falling, g_sequence_free);
+    }
+    
+    set->last_value = value;
+}
+
+static void
+my_watch_hooks_add (GArray **hooks, GCallback func, gpointer data)
+{
+    MyWatchHook hook = { func, data };
+    
+    if (!*hooks)
+        *hooks = g_array_new (FALSE, FALSE, sizeof (MyWatchHook));
+    
+    g_array_append_val (*hooks, hook);
+}
+
+static gboolean
+my_watch_hooks_remove (GArray *hooks, GCallback func, gpointer data)
+{
+    guint i;
+    
+    for (i = 0; hooks && i < hooks->len; i++) {
+        MyWatchHook *hook = &g_array_index (hooks, MyWatchHook, i);
+        
+        if (hook->func == func && hook->data == data) {
+            g_array_remove_index_fast (hooks, i);
+            return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+void
+my_watch_set_add_hook (MyWatchSet *set, MyObjectValueHook func, gpointer data)
+{
+    my_watch_hooks_add (&set->hooks, (GCallback) func, data);
+}
+
+gboolean
+my_watch_set_remove_hook (MyWatchSet *set, MyObjectValueHook func, gpointer data)
+{
+    return my_watch_hooks_remove (set->hooks, (GCallback) func, data);
+}
+
+void
+my_watch_set_add_name_hook (MyWatchSet *set, MyObjectNameHook func, gpointer data)
+{
+    my_watch_hooks_add (&set->name_hooks, (GCallback) func, data);
+}
+
+gboolean
+my_watch_set_remove_name_hook (MyWatchSet *set, MyObjectNameHook func, gpointer data)
+{
+    return my_watch_hooks_remove (set->name_hooks, (GCallback) func, data);
+}
+
+void
+my_watch_set_name_changed (MyWatchSet *set, MyObject *object)
+{
+    guint i;
+    
+    /* Hooks must not add or remove hooks */
+    for (i = 0; set->name_hooks && i < set->name_hooks->len; i++) {
+        MyWatchHook *hook = &g_array_index (set->name_hooks, MyWatchHook, i);
+        
+        ((MyObjectNameHook) hook->func) (object, hook->data);
+    }
+}
+
+/* Collects the watches of the thresholds in [@from, @to] of @sequence */
+static void
+my_watch_set_collect (MyWatchSet *set,
+                      GSequence  *sequence,
+                      gint64      from,
+                      gint64      to,
+                      GPtrArray **fired)
+{
+    MyWatchKey lower = { from, 0 };
+    GSequenceIter *iter = g_sequence_search (sequence, &lower,
+                                             my_watch_key_compare, NULL);
+    
+    for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+        MyWatchKey *key = g_sequence_get (iter);
+        
+        if (key->threshold > to)
+            break;
+        
+        if (!*fired)
+            *fired = g_ptr_array_new_with_free_func ((GDestroyNotify) my_watch_unref);
+        g_ptr_array_add (*fired,
+                         my_watch_ref (g_hash_table_lookup (set->by_id,
+                                                            GUINT_TO_POINTER (key->id))));
+    }
+}
+
+void
+my_watch_set_update (MyWatchSet *set, MyObject *object, gint value)
+{
+    GPtrArray *fired = NULL;
+    gint old_value = set->last_value;
+    guint i;
+    
+    if (value == old_value)
+        return;
+    
+    /* Callbacks that change the value again compare against this one */
+    set->last_value = value;
+    
+    /* Hooks must not add or remove hooks */
+    for (i = 0; set->hooks && i < set->hooks->len; i++) {
+        MyWatchHook *hook = &g_array_index (set->hooks, MyWatchHook, i);
+        
+        ((MyObjectValueHook) hook->func) (object, value, hook->data);
+    }
+    
+    if (!set->by_id)
+        return;
+    
+    /* Rising thresholds t with old <= t < new, falling ones with
+     * new < t <= old */
+    if (value > old_value)
+        my_watch_set_collect (set, set->rising, old_value, (gint64) value - 1, &fired);
+    else
+        my_watch_set_collect (set, set->falling, (gint64) value + 1, old_value, &fired);
+    
+    if (!fired)
+        return;
+    
+    /* Move every delta watch before calling anything, so that callbacks
+     * see a consistent set */
+    for (i = 0; i < fired->len; i++) {
+        MyWatch *watch = g_ptr_array_index (fired, i);
+        
+        if (watch->kind == MY_WATCH_DELTA)
+            my_watch_set_place_delta (set, watch, value);
+    }
+    
+    for (i = 0; i < fired->len; i++) {
+        MyWatch *watch = g_ptr_array_index (fired, i);
+        
+        if (!watch->removed)
+            watch->func (object, value, watch->user_data);
+    }
+    
+    g_ptr_array_unref (fired);
+}
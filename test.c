@@ -1,6 +1,20 @@
 #include <glib.h>
 #include <glib-object.h>
+#include <glib/gstdio.h>
+#include <string.h>
 #include "myobject.h"
+#include "myobject-inline.h"
+#include "myobjectaggregator.h"
+#include "myobjectarray.h"
+#include "myobjectjournal.h"
+#include "myobjectpool.h"
+#include "myobjectregistry.h"
+#include "myobjectsnapshot.h"
+#include "myobjectstore.h"
+#include "myobjecttable.h"
+#include "myobjecttransaction.h"
+#include "myvalue.h"
+#include "memcount.h"
 
 /* Signal handler for value-changed signal */
 static void
@@ -14,6 +28,55 @@ on_value_changed (MyObject *obj, gint new_value, gpointer user_data)
     g_print ("\n");
 }
 
+/* Counts value-changed emissions and records the last value */
+static void
+on_value_changed_count (MyObject *obj, gint new_value, gpointer user_data)
+{
+    gint *state = user_data;
+    
+    state[0]++;
+    state[1] = new_value;
+}
+
+/* Counts notify emissions */
+static void
+on_notify_count (GObject *obj, GParamSpec *pspec, gpointer user_data)
+{
+    gint *count = user_data;
+    
+    (*count)++;
+}
+
+/* Subclass overriding the value_changed class handler */
+typedef struct {
+    MyObject parent_instance;
+    gint class_handler_calls;
+} TestCounter;
+
+typedef struct {
+    MyObjectClass parent_class;
+} TestCounterClass;
+
+G_DEFINE_TYPE (TestCounter, test_counter, MY_TYPE_OBJECT)
+
+static void
+test_counter_value_changed (MyObject *self, gint new_value)
+{
+    ((TestCounter *) self)->class_handler_calls++;
+}
+
+static void
+test_counter_class_init (TestCounterClass *klass)
+{
+    MY_OBJECT_CLASS (klass)->value_changed = test_counter_value_changed;
+}
+
+static void
+test_counter_init (TestCounter *self)
+{
+    self->class_handler_calls = 0;
+}
+
 /* Test basic object creation and properties */
 static void
 test_object_creation (void)
@@ -31,10 +94,79 @@ test_object_creation (void)
     g_assert (MY_IS_OBJECT (obj2));
     g_assert_cmpint (my_object_get_value (obj2), ==, 42);
     
+    /* Create object with initial value and name, inline and on the heap */
+    MyObject *obj3 = my_object_new_full (-7, "full");
+    MyObject *obj4 = my_object_new_full (8, "a name that is too long to be stored inline");
+    MyObject *obj5 = my_object_new_full (9, NULL);
+    g_assert_cmpint (my_object_get_value (obj3), ==, -7);
+    g_assert_cmpstr (my_object_get_name (obj3), ==, "full");
+    g_assert_cmpstr (my_object_get_name (obj4), ==, "a name that is too long to be stored inline");
+    g_assert_null (my_object_get_name (obj5));
+    
+    /* Properties read the directly written fields */
+    gint value;
+    gchar *name;
+    g_object_get (obj3, "value", &value, "name", &name, NULL);
+    g_assert_cmpint (value, ==, -7);
+    g_assert_cmpstr (name, ==, "full");
+    g_free (name);
+    
     g_print ("✓ Object creation tests passed\n");
     
     g_object_unref (obj1);
     g_object_unref (obj2);
+    g_object_unref (obj3);
+    g_object_unref (obj4);
+    g_object_unref (obj5);
+}
+
+/* Test creating many objects in one call */
+static void
+test_new_many (void)
+{
+    g_print ("\n=== Testing Bulk Creation ===\n");
+    
+    const gint values[] = { 1, -2, 3, 4 };
+    const gchar *names[] = {
+        "short",
+        "a name that is too long to be stored inline",
+        NULL,
+        "a name that is too long to be stored inline",
+    };
+    
+    GPtrArray *objects = my_object_new_many (values, names, G_N_ELEMENTS (values));
+    g_assert_cmpuint (objects->len, ==, G_N_ELEMENTS (values));
+    for (guint i = 0; i < objects->len; i++) {
+        MyObject *obj = g_ptr_array_index (objects, i);
+        
+        g_assert (MY_IS_OBJECT (obj));
+        g_assert_cmpint (my_object_get_value (obj), ==, values[i]);
+        g_assert_cmpstr (my_object_get_name (obj), ==, names[i]);
+    }
+    
+    /* Renaming does not disturb the names shared from the block */
+    MyObject *renamed = g_ptr_array_index (objects, 1);
+    my_object_set_name (renamed, "another name that is too long to be stored inline");
+    g_assert_cmpstr (my_object_get_name (renamed), ==,
+                     "another name that is too long to be stored inline");
+    g_assert_cmpstr (my_object_get_name (g_ptr_array_index (objects, 3)), ==, names[3]);
+    
+    /* Objects outlive the array and each other in any order */
+    MyObject *kept = g_object_ref (g_ptr_array_index (objects, 3));
+    g_ptr_array_unref (objects);
+    g_assert_cmpstr (my_object_get_name (kept), ==, names[3]);
+    g_object_unref (kept);
+    
+    /* Unnamed and empty batches */
+    objects = my_object_new_many (values, NULL, 2);
+    g_assert_cmpuint (objects->len, ==, 2);
+    g_assert_null (my_object_get_name (g_ptr_array_index (objects, 0)));
+    g_ptr_array_unref (objects);
+    objects = my_object_new_many (NULL, NULL, 0);
+    g_assert_cmpuint (objects->len, ==, 0);
+    g_ptr_array_unref (objects);
+    
+    g_print ("✓ Bulk creation tests passed\n");
 }
 
 /* Test property getters and setters */
@@ -70,6 +202,58 @@ test_properties (void)
     g_object_unref (obj);
 }
 
+/* Test name storage modes and quarks */
+static void
+test_name_storage (void)
+{
+    g_print ("\n=== Testing Name Storage ===\n");
+    
+    MyObject *obj1 = my_object_new ();
+    MyObject *obj2 = my_object_new ();
+    const gchar *long_name = "A name that is too long to be stored inline";
+    gint name_notifies = 0;
+    
+    g_signal_connect (obj1, "notify::name",
+                      G_CALLBACK (on_notify_count), &name_notifies);
+    
+    /* Short and long names round-trip */
+    my_object_set_name (obj1, "short");
+    g_assert_cmpstr (my_object_get_name (obj1), ==, "short");
+    my_object_set_name (obj1, long_name);
+    g_assert_cmpstr (my_object_get_name (obj1), ==, long_name);
+    my_object_set_name (obj1, my_object_get_name (obj1) + 30);
+    g_assert_cmpstr (my_object_get_name (obj1), ==, "stored inline");
+    g_assert_cmpint (name_notifies, ==, 3);
+    
+    /* Equal names have equal quarks */
+    my_object_set_name (obj2, "stored inline");
+    g_assert_cmpuint (my_object_get_name_quark (obj1), !=, 0);
+    g_assert_cmpuint (my_object_get_name_quark (obj1), ==,
+                      my_object_get_name_quark (obj2));
+    my_object_set_name (obj2, NULL);
+    g_assert_cmpuint (my_object_get_name_quark (obj2), ==, 0);
+    
+    /* Interned names are shared between objects */
+    g_object_set (obj1, "intern-names", TRUE, NULL);
+    my_object_set_intern_names (obj2, TRUE);
+    g_assert_true (my_object_get_intern_names (obj1));
+    g_assert_cmpstr (my_object_get_name (obj1), ==, "stored inline");
+    my_object_set_name (obj1, long_name);
+    my_object_set_name (obj2, long_name);
+    g_assert (my_object_get_name (obj1) == my_object_get_name (obj2));
+    g_assert (my_object_get_name (obj1) == g_intern_string (long_name));
+    
+    /* Setting the same interned name again does not notify */
+    name_notifies = 0;
+    my_object_set_name (obj1, long_name);
+    g_assert_cmpint (name_notifies, ==, 0);
+    
+    g_print ("✓ Name storage tests passed\n");
+    
+    g_object_unref (obj1);
+    g_object_unref (obj2);
+}
+
 /* Test methods */
 static void
 test_methods (void)
@@ -88,11 +272,69 @@ test_methods (void)
     my_object_decrement (obj);
     g_assert_cmpint (my_object_get_value (obj), ==, 9);
     
+    /* Test add and fetch_add */
+    my_object_add (obj, 100);
+    g_assert_cmpint (my_object_get_value (obj), ==, 109);
+    g_assert_cmpint (my_object_fetch_add (obj, -9), ==, 109);
+    g_assert_cmpint (my_object_get_value (obj), ==, 100);
+    my_object_add (obj, -91);
+    g_assert_cmpint (my_object_get_value (obj), ==, 9);
+    
     /* Test to_string */
     gchar *str = my_object_to_string (obj);
     g_print ("String representation: %s\n", str);
     g_assert (g_str_has_prefix (str, "MyObject(name='Counter'"));
     
+    /* Test the allocation-free formatters */
+    gchar buf[64];
+    gchar small[12];
+    g_assert_cmpuint (my_object_format_to_buffer (obj, buf, sizeof buf), ==, strlen (str));
+    g_assert_cmpstr (buf, ==, str);
+    g_assert_cmpuint (my_object_format_to_buffer (obj, NULL, 0), ==, strlen (str));
+    g_assert_cmpuint (my_object_format_to_buffer (obj, small, sizeof small), ==, strlen (str));
+    g_assert_cmpstr (small, ==, "MyObject(na");
+    
+    GString *out = g_string_new ("log: ");
+    my_object_format_into (obj, out);
+    g_assert (g_str_has_suffix (out->str, str));
+    g_assert_cmpuint (out->len, ==, 5 + strlen (str));
+    g_string_free (out, TRUE);
+    
+    /* The peeked string is kept until the object changes */
+    const gchar *peeked = my_object_peek_string (obj);
+    g_assert_cmpstr (peeked, ==, str);
+    g_assert (my_object_peek_string (obj) == peeked);
+    my_object_set_value (obj, -1234567);
+    g_assert_cmpstr (my_object_peek_string (obj), ==, "MyObject(name='Counter', value=-1234567)");
+    my_object_set_value (obj, G_MININT);
+    g_assert (my_object_peek_string (obj) == peeked);
+    g_assert_cmpstr (peeked, ==, "MyObject(name='Counter', value=-2147483648)");
+    my_object_set_name (obj, "A much longer counter name");
+    g_assert_cmpstr (my_object_peek_string (obj), ==,
+                     "MyObject(name='A much longer counter name', value=-2147483648)");
+    my_object_set_name (obj, NULL);
+    g_assert_cmpstr (my_object_peek_string (obj), ==, "MyObject(value=-2147483648)");
+    my_object_set_name (obj, "Counter");
+    my_object_set_value (obj, 9);
+    g_assert_cmpstr (my_object_peek_string (obj), ==, str);
+    
+    /* Writes that bypass the setters are seen too */
+    const gint slots[] = { 1, 2 };
+    MyObjectArray *array = my_object_array_new_from_values (slots, G_N_ELEMENTS (slots));
+    MyObject *view = my_object_array_get_object (array, 1);
+    g_assert_cmpstr (my_object_peek_string (view), ==, "MyObject(value=2)");
+    my_object_array_add_all (array, 40);
+    g_assert_cmpstr (my_object_peek_string (view), ==, "MyObject(value=42)");
+    g_object_unref (view);
+    g_object_unref (array);
+    
+    /* Extreme values use the hand-rolled integer formatter */
+    MyObject *extreme = my_object_new_with_value (G_MININT);
+    gchar *extreme_str = my_object_to_string (extreme);
+    g_assert_cmpstr (extreme_str, ==, "MyObject(value=-2147483648)");
+    g_free (extreme_str);
+    g_object_unref (extreme);
+    
     g_print ("✓ Method tests passed\n");
     
     g_free (str);
@@ -118,6 +360,9 @@ test_signals (void)
     g_print ("Incrementing value...\n");
     my_object_increment (obj);
     
+    g_print ("Adding 0 (should not emit signal)...\n");
+    my_object_add (obj, 0);
+    
     g_print ("Setting same value again (should not emit signal)...\n");
     my_object_set_value (obj, 101);
     
@@ -126,6 +371,1653 @@ test_signals (void)
     g_object_unref (obj);
 }
 
+/* Test batched updates */
+static void
+test_batch_update (void)
+{
+    g_print ("\n=== Testing Batched Updates ===\n");
+    
+    MyObject *obj = my_object_new ();
+    gint changed[2] = { 0, 0 };
+    gint value_notifies = 0;
+    gint name_notifies = 0;
+    
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    g_signal_connect (obj, "notify::value",
+                      G_CALLBACK (on_notify_count), &value_notifies);
+    g_signal_connect (obj, "notify::name",
+                      G_CALLBACK (on_notify_count), &name_notifies);
+    
+    /* Many changes, one emission with the final value */
+    my_object_begin_update (obj);
+    for (gint i = 0; i < 5; i++)
+        my_object_increment (obj);
+    my_object_set_name (obj, "Batched");
+    my_object_set_name (obj, "Batched Again");
+    g_assert_cmpint (my_object_get_value (obj), ==, 5);
+    g_assert_cmpint (changed[0], ==, 0);
+    g_assert_cmpint (value_notifies, ==, 0);
+    g_assert_cmpint (name_notifies, ==, 0);
+    my_object_end_update (obj);
+    
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (changed[1], ==, 5);
+    g_assert_cmpint (value_notifies, ==, 1);
+    g_assert_cmpint (name_notifies, ==, 1);
+    
+    /* Nested batches only report when the outermost one ends */
+    my_object_begin_update (obj);
+    my_object_begin_update (obj);
+    my_object_set_value (obj, 50);
+    my_object_end_update (obj);
+    g_assert_cmpint (changed[0], ==, 1);
+    my_object_end_update (obj);
+    g_assert_cmpint (changed[0], ==, 2);
+    g_assert_cmpint (changed[1], ==, 50);
+    
+    /* A batch that ends at its starting value emits nothing */
+    my_object_begin_update (obj);
+    my_object_increment (obj);
+    my_object_decrement (obj);
+    my_object_end_update (obj);
+    g_assert_cmpint (changed[0], ==, 2);
+    g_assert_cmpint (value_notifies, ==, 2);
+    
+    g_print ("✓ Batched update tests passed\n");
+    
+    g_object_unref (obj);
+}
+
+/* Increments the object passed as data from a worker thread */
+static gpointer
+increment_worker (gpointer data)
+{
+    for (gint i = 0; i < 10000; i++)
+        my_object_increment (MY_OBJECT (data));
+    
+    return NULL;
+}
+
+/* Tries to open a batch on the object passed as data from a worker
+ * thread, and adds 10 either way */
+static gpointer
+batch_worker (gpointer data)
+{
+    gboolean batched = my_object_begin_update (MY_OBJECT (data));
+    
+    my_object_add (MY_OBJECT (data), 10);
+    if (batched)
+        my_object_end_update (MY_OBJECT (data));
+    
+    return GINT_TO_POINTER (batched);
+}
+
+/* Test atomic mode */
+static void
+test_atomic_mode (void)
+{
+    g_print ("\n=== Testing Atomic Mode ===\n");
+    
+    MyObject *obj = my_object_new_atomic (10);
+    GThread *threads[4];
+    gint changed[2] = { 0, 0 };
+    gboolean atomic;
+    
+    g_object_get (obj, "atomic", &atomic, NULL);
+    g_assert_true (atomic);
+    g_assert_cmpint (my_object_get_value (obj), ==, 10);
+    
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    
+    for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+        threads[i] = g_thread_new ("incrementer", increment_worker, obj);
+    for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+        g_thread_join (threads[i]);
+    
+    g_assert_cmpint (my_object_get_value (obj), ==, 40010);
+    
+    /* Notification is deferred to the main context and coalesced */
+    g_assert_cmpint (changed[0], ==, 0);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (changed[1], ==, 40010);
+    
+    /* Setting the current value again schedules nothing */
+    my_object_set_value (obj, 40010);
+    g_assert_false (g_main_context_pending (NULL));
+    
+    /* fetch_add is a single atomic step returning the old value */
+    g_assert_cmpint (my_object_fetch_add (obj, 5), ==, 40010);
+    g_assert_cmpint (my_object_get_value (obj), ==, 40015);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 2);
+    g_assert_cmpint (changed[1], ==, 40015);
+    
+    /* A batch holds the notify context, so what other threads write is
+     * delivered once it ends and never in the middle of it */
+    g_assert_true (my_object_begin_update (obj));
+    g_assert_true (g_main_context_is_owner (g_main_context_default ()));
+    threads[0] = g_thread_new ("incrementer", increment_worker, obj);
+    g_thread_join (threads[0]);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 2);
+    
+    /* Meanwhile other threads cannot open a batch but can still write */
+    threads[0] = g_thread_new ("batcher", batch_worker, obj);
+    g_assert_false (GPOINTER_TO_INT (g_thread_join (threads[0])));
+    g_assert_cmpint (my_object_get_value (obj), ==, 50025);
+    my_object_end_update (obj);
+    g_assert_false (g_main_context_is_owner (g_main_context_default ()));
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 3);
+    g_assert_cmpint (changed[1], ==, 50025);
+    
+    /* Once the context is free, they can */
+    threads[0] = g_thread_new ("batcher", batch_worker, obj);
+    g_assert_true (GPOINTER_TO_INT (g_thread_join (threads[0])));
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 4);
+    g_assert_cmpint (changed[1], ==, 50035);
+    
+    g_print ("✓ Atomic mode tests passed\n");
+    
+    g_object_unref (obj);
+}
+
+/* Test sharded counters */
+static void
+test_sharded_mode (void)
+{
+    g_print ("\n=== Testing Sharded Mode ===\n");
+    
+    MyObject *obj = my_object_new_sharded (5);
+    GThread *threads[8];
+    gint changed[2] = { 0, 0 };
+    gboolean atomic, sharded;
+    
+    g_object_get (obj, "atomic", &atomic, "sharded", &sharded, NULL);
+    g_assert_true (atomic);
+    g_assert_true (sharded);
+    g_assert_cmpint (my_object_get_value (obj), ==, 5);
+    
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    
+    for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+        threads[i] = g_thread_new ("incrementer", increment_worker, obj);
+    for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+        g_thread_join (threads[i]);
+    
+    /* Once the writers are done the fold is exact */
+    g_assert_cmpint (my_object_get_value (obj), ==, 80005);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[1], ==, 80005);
+    
+    /* Setting adds the difference; wrap-around matches plain objects */
+    my_object_set_value (obj, G_MAXINT);
+    my_object_increment (obj);
+    g_assert_cmpint (my_object_get_value (obj), ==, G_MININT);
+    my_object_set_value (obj, 0);
+    g_assert_cmpint (my_object_fetch_add (obj, 3), ==, 0);
+    g_assert_cmpint (my_object_get_value (obj), ==, 3);
+    
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpint (changed[1], ==, 3);
+    
+    g_print ("✓ Sharded mode tests passed\n");
+    
+    g_object_unref (obj);
+}
+
+/* Writes increasing values to the object passed as data */
+static gpointer
+set_value_worker (gpointer data)
+{
+    for (gint i = 1; i <= 10000; i++)
+        my_object_set_value (MY_OBJECT (data), i);
+    
+    return NULL;
+}
+
+/* Test deferred delivery on a notify context */
+static void
+test_notify_context (void)
+{
+    g_print ("\n=== Testing Notify Context ===\n");
+    
+    GMainContext *context = g_main_context_new ();
+    MyObject *obj = my_object_new ();
+    gint changed[2] = { 0, 0 };
+    gint value_notifies = 0;
+    
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    g_signal_connect (obj, "notify::value",
+                      G_CALLBACK (on_notify_count), &value_notifies);
+    
+    my_object_set_notify_context (obj, context);
+    g_assert (my_object_get_notify_context (obj) == context);
+    
+    /* Writes only queue the object; delivery carries the latest value */
+    my_object_set_value (obj, 1);
+    my_object_set_value (obj, 2);
+    my_object_increment (obj);
+    g_assert_cmpint (changed[0], ==, 0);
+    g_assert_true (g_main_context_pending (context));
+    
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (changed[1], ==, 3);
+    g_assert_cmpint (value_notifies, ==, 1);
+    
+    /* Changing and restoring the value before delivery reports nothing */
+    my_object_set_value (obj, 4);
+    my_object_set_value (obj, 3);
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 1);
+    
+    /* A producer thread never runs the handlers itself */
+    GThread *thread = g_thread_new ("producer", set_value_worker, obj);
+    g_thread_join (thread);
+    g_assert_cmpint (changed[0], ==, 1);
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (changed[0], ==, 2);
+    g_assert_cmpint (changed[1], ==, 10000);
+    
+    /* Atomic objects can be moved to another context too */
+    MyObject *counter = my_object_new_atomic (0);
+    gint counter_changed[2] = { 0, 0 };
+    g_signal_connect (counter, "value-changed",
+                      G_CALLBACK (on_value_changed_count), counter_changed);
+    my_object_set_notify_context (counter, context);
+    my_object_increment (counter);
+    g_assert_false (g_main_context_pending (NULL));
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (counter_changed[0], ==, 1);
+    
+    /* Objects created with a value report the first change back to 0 */
+    MyObject *full = my_object_new_full (5, "notify-full");
+    gint full_changed[2] = { 0, -1 };
+    g_signal_connect (full, "value-changed",
+                      G_CALLBACK (on_value_changed_count), full_changed);
+    my_object_set_notify_context (full, context);
+    my_object_set_value (full, 0);
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (full_changed[0], ==, 1);
+    g_assert_cmpint (full_changed[1], ==, 0);
+    
+    my_object_set_value (full, 7);
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    MyObject *full_clone = my_object_clone (full);
+    g_signal_connect (full_clone, "value-changed",
+                      G_CALLBACK (on_value_changed_count), full_changed);
+    my_object_set_notify_context (full_clone, context);
+    my_object_set_value (full_clone, 0);
+    while (g_main_context_iteration (context, FALSE))
+        ;
+    g_assert_cmpint (full_changed[0], ==, 3);
+    g_assert_cmpint (full_changed[1], ==, 0);
+    g_object_unref (full_clone);
+    g_object_unref (full);
+    
+    /* NULL restores synchronous delivery */
+    my_object_set_notify_context (obj, NULL);
+    my_object_set_value (obj, 5);
+    g_assert_cmpint (changed[0], ==, 3);
+    g_assert_false (g_main_context_pending (context));
+    
+    g_print ("✓ Notify context tests passed\n");
+    
+    g_object_unref (counter);
+    g_object_unref (obj);
+    g_main_context_unref (context);
+}
+
+/* Test the structure-of-arrays collection */
+static void
+test_object_array (void)
+{
+    g_print ("\n=== Testing Object Array ===\n");
+    
+    gint values[37];
+    gint64 expected_sum = 0;
+    gint changed[2] = { 0, 0 };
+    
+    /* Odd length so every kernel also runs its scalar tail */
+    for (guint i = 0; i < G_N_ELEMENTS (values); i++) {
+        values[i] = (i % 3 == 0) ? -(gint) i * 1000 : (gint) i * 7;
+        expected_sum += values[i];
+    }
+    values[20] = G_MAXINT;
+    expected_sum += G_MAXINT - 20 * 7;
+    
+    MyObjectArray *array = my_object_array_new_from_values (values, G_N_ELEMENTS (values));
+    g_assert_cmpuint (my_object_array_get_length (array), ==, 37);
+    g_assert_cmpint (my_object_array_sum (array), ==, expected_sum);
+    g_assert_cmpint (my_object_array_min (array), ==, -36000);
+    g_assert_cmpint (my_object_array_max (array), ==, G_MAXINT);
+    
+    /* Views share the array slot */
+    MyObject *view = my_object_array_get_object (array, 4);
+    g_assert (my_object_array_get_object (array, 4) == view);
+    g_object_unref (view);
+    g_assert_cmpint (my_object_get_value (view), ==, 28);
+    g_signal_connect (view, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    
+    my_object_set_value (view, 5);
+    g_assert_cmpint (my_object_array_get_value (array, 4), ==, 5);
+    my_object_array_set_value (array, 4, 6);
+    g_assert_cmpint (my_object_get_value (view), ==, 6);
+    g_assert_cmpint (changed[0], ==, 2);
+    
+    /* Bulk kernels notify live views once */
+    my_object_array_add_all (array, 10);
+    g_assert_cmpint (my_object_array_get_value (array, 0), ==, 10);
+    g_assert_cmpint (my_object_get_value (view), ==, 16);
+    g_assert_cmpint (changed[0], ==, 3);
+    g_assert_cmpint (changed[1], ==, 16);
+    my_object_array_increment_all (array);
+    g_assert_cmpint (my_object_array_get_value (array, 36), ==, -35989);
+    g_assert_cmpint (changed[1], ==, 17);
+    
+    /* Views follow the column when it is reallocated */
+    for (gint i = 0; i < 1000; i++)
+        g_assert_cmpuint (my_object_array_append (array, i), ==, 37 + (guint) i);
+    g_assert_cmpint (my_object_get_value (view), ==, 17);
+    my_object_set_value (view, 18);
+    g_assert_cmpint (my_object_array_get_value (array, 4), ==, 18);
+    
+    g_print ("Sum of %u elements: %" G_GINT64_FORMAT "\n",
+             my_object_array_get_length (array),
+             my_object_array_sum (array));
+    
+    g_print ("✓ Object array tests passed\n");
+    
+    g_object_unref (view);
+    g_object_unref (array);
+}
+
+/* Doubles the elements at even indices and counts the calls */
+static void
+double_even_elements (gint *value, guint index, gpointer user_data)
+{
+    if (index % 2 == 0)
+        *value *= 2;
+    g_atomic_int_inc ((gint *) user_data);
+}
+
+/* Checks that handlers run on the thread that started the operation */
+static void
+on_value_changed_check_thread (MyObject *obj, gint new_value, gpointer user_data)
+{
+    g_assert (g_thread_self () == user_data);
+}
+
+/* Test the parallel bulk kernels */
+static void
+test_array_parallel (void)
+{
+    g_print ("\n=== Testing Parallel Array Kernels ===\n");
+    
+    /* Several chunks, the last one partial */
+    const guint n = 100003;
+    gint *values = g_new (gint, n);
+    gint even_changed[2] = { 0, 0 };
+    gint odd_changed[2] = { 0, 0 };
+    gint calls = 0;
+    
+    for (guint i = 0; i < n; i++)
+        values[i] = (gint) (i % 1000) - 500;
+    values[77777] = G_MAXINT;
+    values[12] = G_MININT;
+    
+    MyObjectArray *array = my_object_array_new_from_values (values, n);
+    g_assert_cmpint (my_object_array_sum_parallel (array), ==, my_object_array_sum (array));
+    g_assert_cmpint (my_object_array_min_parallel (array), ==, G_MININT);
+    g_assert_cmpint (my_object_array_max_parallel (array), ==, G_MAXINT);
+    
+    MyObject *even = my_object_array_get_object (array, 60000);
+    MyObject *odd = my_object_array_get_object (array, 60001);
+    g_signal_connect (even, "value-changed", G_CALLBACK (on_value_changed_count), even_changed);
+    g_signal_connect (odd, "value-changed", G_CALLBACK (on_value_changed_count), odd_changed);
+    g_signal_connect (even, "value-changed", G_CALLBACK (on_value_changed_check_thread), g_thread_self ());
+    
+    /* Only views whose value changed are notified, after the fact */
+    my_object_array_foreach_parallel (array, double_even_elements, &calls);
+    g_assert_cmpint (calls, ==, (gint) n);
+    g_assert_cmpint (even_changed[0], ==, 1);
+    g_assert_cmpint (even_changed[1], ==, -1000);
+    g_assert_cmpint (odd_changed[0], ==, 0);
+    for (guint i = 0; i < n; i += 997)
+        g_assert_cmpint (my_object_array_get_value (array, i), ==,
+                         i % 2 == 0 ? (gint) ((guint) values[i] * 2) : values[i]);
+    
+    gint64 before = my_object_array_sum (array);
+    my_object_array_add_all_parallel (array, 3);
+    my_object_array_increment_all_parallel (array);
+    g_assert_cmpint (my_object_array_get_value (array, 60001), ==, values[60001] + 4);
+    g_assert_cmpint (odd_changed[0], ==, 2);
+    g_assert_cmpint (even_changed[0], ==, 3);
+    
+    /* Only the G_MAXINT element wraps around */
+    g_assert_cmpint (my_object_array_sum_parallel (array), ==,
+                     before + 4 * (gint64) n - ((gint64) 1 << 32));
+    
+    /* Small and empty arrays run on the calling thread */
+    MyObjectArray *small = my_object_array_new_from_values (values, 10);
+    MyObjectArray *empty = my_object_array_new ();
+    g_assert_cmpint (my_object_array_sum_parallel (small), ==, my_object_array_sum (small));
+    g_assert_cmpint (my_object_array_sum_parallel (empty), ==, 0);
+    g_assert_cmpint (my_object_array_min_parallel (empty), ==, G_MAXINT);
+    calls = 0;
+    my_object_array_foreach_parallel (empty, double_even_elements, &calls);
+    g_assert_cmpint (calls, ==, 0);
+    
+    g_print ("✓ Parallel array kernel tests passed\n");
+    
+    g_object_unref (small);
+    g_object_unref (empty);
+    g_object_unref (even);
+    g_object_unref (odd);
+    g_object_unref (array);
+    g_free (values);
+}
+
+/* Test object recycling */
+static void
+test_object_pool (void)
+{
+    g_print ("\n=== Testing Object Pool ===\n");
+    
+    MyObjectPool *pool = my_object_pool_new (2);
+    gint changed[2] = { 0, 0 };
+    
+    g_assert_cmpuint (my_object_pool_get_n_idle (pool), ==, 2);
+    
+    MyObject *obj = my_object_pool_acquire (pool, 5);
+    g_assert_cmpuint (my_object_pool_get_n_idle (pool), ==, 1);
+    g_assert_cmpint (my_object_get_value (obj), ==, 5);
+    g_assert_null (my_object_get_name (obj));
+    
+    my_object_set_name (obj, "Pooled");
+    g_assert_cmpstr (my_object_get_name (obj), ==, "Pooled");
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    my_object_increment (obj);
+    g_assert_cmpint (changed[0], ==, 1);
+    
+    /* Released objects come back reset and without handlers */
+    MyObject *released = obj;
+    my_object_pool_release (pool, obj);
+    g_assert_cmpuint (my_object_pool_get_n_idle (pool), ==, 2);
+    
+    obj = my_object_pool_acquire (pool, 7);
+    g_assert (obj == released);
+    g_assert_cmpint (my_object_get_value (obj), ==, 7);
+    g_assert_null (my_object_get_name (obj));
+    my_object_increment (obj);
+    g_assert_cmpint (changed[0], ==, 1);
+    
+    /* Objects still referenced elsewhere are not recycled */
+    g_object_ref (obj);
+    my_object_pool_release (pool, obj);
+    g_assert_cmpuint (my_object_pool_get_n_idle (pool), ==, 1);
+    g_assert_cmpuint (G_OBJECT (obj)->ref_count, ==, 1);
+    
+    /* Pooled objects outlive the pool */
+    g_object_unref (pool);
+    my_object_set_name (obj, "Survivor");
+    g_assert_cmpstr (my_object_get_name (obj), ==, "Survivor");
+    
+    g_print ("✓ Object pool tests passed\n");
+    
+    g_object_unref (obj);
+}
+
+/* Records the order of value-changed emissions and the peer's value */
+typedef struct {
+    MyObject *peer;
+    GString *order;
+    gint peer_value;
+} TransactionLog;
+
+static void
+on_value_changed_log (MyObject *obj, gint new_value, gpointer user_data)
+{
+    TransactionLog *log = user_data;
+    
+    g_string_append (log->order, my_object_get_name (obj));
+    if (obj != log->peer)
+        log->peer_value = my_object_get_value (log->peer);
+}
+
+/* Commits the transaction passed as data from a worker thread */
+static gpointer
+commit_worker (gpointer data)
+{
+    return GINT_TO_POINTER (my_object_transaction_commit (data));
+}
+
+/* Test batched updates across several objects */
+static void
+test_transaction (void)
+{
+    g_print ("\n=== Testing Transactions ===\n");
+    
+    MyObjectTransaction *tx = my_object_transaction_new ();
+    MyObject *a = my_object_new_with_value (1);
+    MyObject *b = my_object_new_with_value (2);
+    MyObject *c = my_object_new_with_value (3);
+    TransactionLog log = { c, g_string_new (NULL), 0 };
+    gint changed[2] = { 0, 0 };
+    gint value_notifies = 0;
+    
+    my_object_set_name (a, "a");
+    my_object_set_name (b, "b");
+    my_object_set_name (c, "c");
+    g_signal_connect (a, "value-changed", G_CALLBACK (on_value_changed_log), &log);
+    g_signal_connect (b, "value-changed", G_CALLBACK (on_value_changed_log), &log);
+    g_signal_connect (c, "value-changed", G_CALLBACK (on_value_changed_log), &log);
+    g_signal_connect (b, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    g_signal_connect (b, "notify::value",
+                      G_CALLBACK (on_notify_count), &value_notifies);
+    
+    /* Nothing is applied before the commit */
+    my_object_transaction_set_value (tx, b, 20);
+    my_object_transaction_set_value (tx, a, 10);
+    my_object_transaction_set_value (tx, b, 21);
+    my_object_transaction_set_value (tx, c, 30);
+    my_object_transaction_set_value (tx, b, 22);
+    g_assert_cmpuint (my_object_transaction_get_n_objects (tx), ==, 3);
+    g_assert_cmpint (my_object_get_value (b), ==, 2);
+    g_assert_cmpint (changed[0], ==, 0);
+    
+    /* Duplicate writes collapse, objects notify in first-touch order and
+     * every handler sees the whole transaction applied */
+    my_object_transaction_commit (tx);
+    g_assert_cmpuint (my_object_transaction_get_n_objects (tx), ==, 0);
+    g_assert_cmpstr (log.order->str, ==, "bac");
+    g_assert_cmpint (log.peer_value, ==, 30);
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (changed[1], ==, 22);
+    g_assert_cmpint (value_notifies, ==, 1);
+    g_assert_cmpint (my_object_get_value (a), ==, 10);
+    
+    /* Writes back to the current value emit nothing */
+    my_object_transaction_set_value (tx, b, 99);
+    my_object_transaction_set_value (tx, b, 22);
+    my_object_transaction_set_name (tx, b, "renamed");
+    my_object_transaction_commit (tx);
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpstr (my_object_get_name (b), ==, "renamed");
+    
+    /* Cleared changes are never applied */
+    my_object_transaction_set_value (tx, a, 100);
+    my_object_transaction_clear (tx);
+    my_object_transaction_commit (tx);
+    g_assert_cmpint (my_object_get_value (a), ==, 10);
+    
+    /* Objects that cannot be batched on the committing thread are left
+     * pending and untouched, the others are applied */
+    MyObject *atomic = my_object_new_atomic (1);
+    my_object_transaction_set_value (tx, atomic, 2);
+    my_object_transaction_set_value (tx, a, 11);
+    g_assert_true (g_main_context_acquire (NULL));
+    GThread *thread = g_thread_new ("committer", commit_worker, tx);
+    g_assert_false (GPOINTER_TO_INT (g_thread_join (thread)));
+    g_main_context_release (NULL);
+    g_assert_cmpint (my_object_get_value (a), ==, 11);
+    g_assert_cmpint (my_object_get_value (atomic), ==, 1);
+    g_assert_cmpuint (my_object_transaction_get_n_objects (tx), ==, 1);
+    g_assert_true (my_object_transaction_commit (tx));
+    g_assert_cmpint (my_object_get_value (atomic), ==, 2);
+    g_assert_cmpuint (my_object_transaction_get_n_objects (tx), ==, 0);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    
+    g_print ("✓ Transaction tests passed\n");
+    
+    g_object_unref (atomic);
+    g_string_free (log.order, TRUE);
+    g_object_unref (tx);
+    g_object_unref (a);
+    g_object_unref (b);
+    g_object_unref (c);
+}
+
+/* Test that skipping unobserved emissions loses nothing */
+static void
+test_signal_fast_path (void)
+{
+    g_print ("\n=== Testing Signal Fast Path ===\n");
+    
+    TestCounter *counter = g_object_new (test_counter_get_type (), NULL);
+    MyObject *obj = MY_OBJECT (counter);
+    gint changed[2] = { 0, 0 };
+    gint value_notifies = 0;
+    
+    /* The class handler alone keeps the emission alive */
+    my_object_increment (obj);
+    g_assert_cmpint (counter->class_handler_calls, ==, 1);
+    
+    /* Handlers connected later, and handlers for the detail, are seen */
+    gulong id = g_signal_connect (obj, "value-changed",
+                                  G_CALLBACK (on_value_changed_count), changed);
+    g_signal_connect (obj, "notify::value",
+                      G_CALLBACK (on_notify_count), &value_notifies);
+    my_object_add (obj, 41);
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (changed[1], ==, 42);
+    g_assert_cmpint (value_notifies, ==, 1);
+    g_assert_cmpint (counter->class_handler_calls, ==, 2);
+    
+    /* Blocked and disconnected handlers are not run */
+    g_signal_handler_block (obj, id);
+    my_object_increment (obj);
+    g_assert_cmpint (changed[0], ==, 1);
+    g_signal_handler_unblock (obj, id);
+    g_signal_handler_disconnect (obj, id);
+    my_object_increment (obj);
+    g_assert_cmpint (changed[0], ==, 1);
+    g_assert_cmpint (value_notifies, ==, 3);
+    g_assert_cmpint (counter->class_handler_calls, ==, 4);
+    
+    g_print ("✓ Signal fast path tests passed\n");
+    
+    g_object_unref (obj);
+}
+
+/* Test the unchecked inline accessors */
+static void
+test_inline_accessors (void)
+{
+    g_print ("\n=== Testing Inline Accessors ===\n");
+    
+    MyObject *obj = my_object_new_with_value (42);
+    
+    g_assert_cmpint (my_object_get_value_fast (obj), ==, 42);
+    g_assert_null (my_object_get_name_fast (obj));
+    my_object_set_name (obj, "a name that is too long to be stored inline");
+    g_assert (my_object_get_name_fast (obj) == my_object_get_name (obj));
+    my_object_set_name (obj, "inline");
+    g_assert_cmpstr (my_object_get_name_fast (obj), ==, "inline");
+    
+    /* Subclass instances share the layout */
+    MyObject *counter = g_object_new (test_counter_get_type (), "value", 7, NULL);
+    g_assert_cmpint (my_object_get_value_fast (counter), ==, 7);
+    
+    /* Views read their collection slot */
+    gint values[] = { 1, 2, 3 };
+    MyObjectArray *array = my_object_array_new_from_values (values, G_N_ELEMENTS (values));
+    MyObject *view = my_object_array_get_object (array, 2);
+    my_object_array_set_value (array, 2, 30);
+    g_assert_cmpint (my_object_get_value_fast (view), ==, 30);
+    
+    /* Atomic and sharded objects take the out-of-line path */
+    MyObject *atomic = my_object_new_atomic (3);
+    MyObject *sharded = my_object_new_sharded (4);
+    my_object_increment (atomic);
+    my_object_add (sharded, 10);
+    g_assert_cmpint (my_object_get_value_fast (atomic), ==, 4);
+    g_assert_cmpint (my_object_get_value_fast (sharded), ==, 14);
+    
+    g_print ("✓ Inline accessor tests passed\n");
+    
+    g_object_unref (atomic);
+    g_object_unref (sharded);
+    g_object_unref (view);
+    g_object_unref (array);
+    g_object_unref (counter);
+    g_object_unref (obj);
+}
+
+/* Test the MyValue boxed record */
+static void
+test_value_struct (void)
+{
+    g_print ("\n=== Testing MyValue ===\n");
+    
+    MyValue *value = my_value_new (G_MAXINT, "record");
+    my_value_increment (value);
+    g_assert_cmpint (value->value, ==, G_MININT);
+    my_value_decrement (value);
+    my_value_add (value, -10);
+    g_assert_cmpint (value->value, ==, G_MAXINT - 10);
+    
+    gchar *str = my_value_to_string (value);
+    g_assert_cmpstr (str, ==, "MyValue(name='record', value=2147483637)");
+    g_free (str);
+    
+    MyValue *copy = g_boxed_copy (MY_TYPE_VALUE, value);
+    g_assert (copy != value);
+    g_assert (my_value_equal (copy, value));
+    my_value_set_name (copy, my_value_get_name (copy));
+    my_value_set_name (copy, NULL);
+    g_assert (!my_value_equal (copy, value));
+    g_boxed_free (MY_TYPE_VALUE, copy);
+    
+    /* Caller-owned storage */
+    MyValue stack;
+    my_value_init (&stack, 5, NULL);
+    str = my_value_to_string (&stack);
+    g_assert_cmpstr (str, ==, "MyValue(value=5)");
+    g_free (str);
+    my_value_clear (&stack);
+    my_value_clear (&stack);
+    g_assert_cmpint (stack.value, ==, 0);
+    
+    /* Conversions keep value and name; applying notifies once */
+    MyObject *obj = my_value_to_object (value);
+    g_assert_cmpint (my_object_get_value (obj), ==, G_MAXINT - 10);
+    g_assert_cmpstr (my_object_get_name (obj), ==, "record");
+    
+    gint state[2] = { 0, 0 };
+    gint n_notify = 0;
+    g_signal_connect (obj, "value-changed", G_CALLBACK (on_value_changed_count), state);
+    g_signal_connect (obj, "notify::name", G_CALLBACK (on_notify_count), &n_notify);
+    my_value_init (&stack, 99, "applied");
+    my_value_apply_to_object (&stack, obj);
+    my_value_clear (&stack);
+    g_assert_cmpint (state[0], ==, 1);
+    g_assert_cmpint (state[1], ==, 99);
+    g_assert_cmpint (n_notify, ==, 1);
+    
+    MyValue *snapshot = my_value_new_from_object (obj);
+    g_assert_cmpint (snapshot->value, ==, 99);
+    g_assert_cmpstr (my_value_get_name (snapshot), ==, "applied");
+    
+    g_assert (G_TYPE_IS_BOXED (MY_TYPE_VALUE));
+    
+    g_print ("✓ MyValue tests passed\n");
+    
+    my_value_free (snapshot);
+    my_value_free (value);
+    my_value_free (NULL);
+    g_object_unref (obj);
+}
+
+/* Test the allocation contracts of the hot paths */
+static void
+test_allocation_contracts (void)
+{
+    g_print ("\n=== Testing Allocation Contracts ===\n");
+    
+    if (!memcount_available ()) {
+        g_print ("Allocation counting is not available here, skipped\n");
+        return;
+    }
+    
+    MyObject *obj = my_object_new_full (1, "Contract");
+    gchar buf[64];
+    gint checksum = 0;
+    guint64 n_allocs;
+    
+    /* Type and class data are allocated on first use */
+    my_object_set_value (obj, 2);
+    my_object_increment (obj);
+    g_free (my_object_to_string (obj));
+    my_object_peek_string (obj);
+    
+    /* Reads and writes without handlers never allocate */
+    memcount_begin ();
+    for (gint i = 0; i < 1000; i++) {
+        my_object_set_value (obj, i);
+        my_object_increment (obj);
+        my_object_decrement (obj);
+        my_object_add (obj, 3);
+        checksum += my_object_get_value (obj);
+        my_object_format_to_buffer (obj, buf, sizeof buf);
+    }
+    n_allocs = memcount_end ();
+    g_assert_cmpuint (n_allocs, ==, 0);
+    
+    /* to_string makes one exactly sized allocation */
+    memcount_begin ();
+    for (guint i = 0; i < 100; i++)
+        g_free (my_object_to_string (obj));
+    n_allocs = memcount_end ();
+    g_assert_cmpuint (n_allocs, <=, 100);
+    
+    /* The cached string is reformatted in place for any value */
+    memcount_begin ();
+    for (gint i = 0; i < 100; i++) {
+        my_object_set_value (obj, i % 2 ? G_MININT + i : G_MAXINT - i);
+        checksum += (gint) strlen (my_object_peek_string (obj));
+    }
+    n_allocs = memcount_end ();
+    g_assert_cmpuint (n_allocs, ==, 0);
+    
+    g_print ("✓ Allocation contract tests passed (checksum %d)\n", checksum);
+    
+    g_object_unref (obj);
+}
+
+/* Test the optional instrumentation counters */
+static void
+test_stats (void)
+{
+    g_print ("\n=== Testing Instrumentation ===\n");
+    
+    MyObjectStats before, after, counter_before, counter_after;
+    gint changed[2] = { 0, 0 };
+    gboolean enabled = my_object_get_stats (MY_TYPE_OBJECT, &before);
+    
+    my_object_get_stats (test_counter_get_type (), &counter_before);
+    
+    MyObject *obj = my_object_new ();
+    MyObject *counter = g_object_new (test_counter_get_type (), NULL);
+    
+    /* Construction writes the fields without counting setter calls */
+    g_object_unref (my_object_new_full (5, "constructed"));
+    
+    my_object_set_value (obj, 5);
+    my_object_set_value (obj, 5);
+    g_signal_connect (obj, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    my_object_set_value (obj, 6);
+    my_object_set_name (obj, "a name that is too long to be stored inline");
+    
+    g_assert (my_object_get_stats (MY_TYPE_OBJECT, &after) == enabled);
+    my_object_get_stats (test_counter_get_type (), &counter_after);
+    
+    if (enabled) {
+        g_assert_cmpuint (after.n_alive - before.n_alive, ==, 1);
+        g_assert_cmpuint (after.n_set_value - before.n_set_value, ==, 3);
+        g_assert_cmpuint (after.n_set_value_noop - before.n_set_value_noop, ==, 1);
+        g_assert_cmpuint (after.n_signals_emitted - before.n_signals_emitted, ==, 1);
+        g_assert_cmpuint (after.n_name_reallocs - before.n_name_reallocs, ==, 1);
+        g_assert_cmpuint (after.handler_time_ns, >=, before.handler_time_ns);
+        
+        /* Subclasses are counted separately */
+        g_assert_cmpuint (counter_after.n_alive - counter_before.n_alive, ==, 1);
+        g_assert_cmpuint (counter_after.n_set_value, ==, counter_before.n_set_value);
+    } else {
+        g_assert_cmpuint (after.n_alive, ==, 0);
+        g_assert_cmpuint (after.n_set_value, ==, 0);
+        g_assert_cmpuint (after.n_signals_emitted, ==, 0);
+    }
+    g_assert_cmpint (changed[0], ==, 1);
+    
+    g_object_unref (obj);
+    g_object_unref (counter);
+    
+    if (enabled) {
+        my_object_get_stats (MY_TYPE_OBJECT, &after);
+        g_assert_cmpuint (after.n_alive, ==, before.n_alive);
+    }
+    
+    g_print ("✓ Instrumentation tests passed (counters %s)\n",
+             enabled ? "enabled" : "compiled out");
+}
+
+/* Records the values a watch fired with */
+static void
+on_watch_log (MyObject *obj, gint value, gpointer user_data)
+{
+    GArray *log = user_data;
+    
+    g_array_append_val (log, value);
+}
+
+/* Removes the watch whose ID it is given, from inside its own call */
+static void
+on_watch_remove_self (MyObject *obj, gint value, gpointer user_data)
+{
+    guint *id = user_data;
+    
+    my_object_remove_watch (obj, *id);
+    *id = 0;
+}
+
+static void
+on_watch_destroy (gpointer user_data)
+{
+    gint *n_destroyed = user_data;
+    
+    (*n_destroyed)++;
+}
+
+/* Test threshold and delta watches */
+static void
+test_watches (void)
+{
+    g_print ("\n=== Testing Watches ===\n");
+    
+    MyObject *obj = my_object_new_with_value (0);
+    GArray *above = g_array_new (FALSE, FALSE, sizeof (gint));
+    GArray *below = g_array_new (FALSE, FALSE, sizeof (gint));
+    GArray *delta = g_array_new (FALSE, FALSE, sizeof (gint));
+    
+    /* Above and below fire on crossings only */
+    guint above_id = my_object_add_watch (obj, MY_WATCH_ABOVE, 10, on_watch_log, above, NULL);
+    my_object_add_watch (obj, MY_WATCH_BELOW, 0, on_watch_log, below, NULL);
+    g_assert_cmpuint (above_id, >, 0);
+    my_object_set_value (obj, 10);
+    my_object_set_value (obj, 11);
+    my_object_set_value (obj, 50);
+    my_object_set_value (obj, 5);
+    my_object_set_value (obj, 20);
+    my_object_set_value (obj, -3);
+    my_object_set_value (obj, -4);
+    my_object_set_value (obj, 0);
+    g_assert_cmpuint (above->len, ==, 2);
+    g_assert_cmpint (g_array_index (above, gint, 0), ==, 11);
+    g_assert_cmpint (g_array_index (above, gint, 1), ==, 20);
+    g_assert_cmpuint (below->len, ==, 1);
+    g_assert_cmpint (g_array_index (below, gint, 0), ==, -3);
+    
+    /* Delta watches measure from the value at the last firing */
+    guint delta_id = my_object_add_watch (obj, MY_WATCH_DELTA, 5, on_watch_log, delta, NULL);
+    my_object_set_value (obj, 5);
+    my_object_set_value (obj, 6);
+    my_object_set_value (obj, 1);
+    my_object_set_value (obj, 0);
+    g_assert_cmpuint (delta->len, ==, 2);
+    g_assert_cmpint (g_array_index (delta, gint, 0), ==, 6);
+    g_assert_cmpint (g_array_index (delta, gint, 1), ==, 0);
+    
+    /* A batch is one change from its start to its end */
+    g_array_set_size (above, 0);
+    my_object_begin_update (obj);
+    my_object_set_value (obj, 100);
+    my_object_set_value (obj, 1);
+    my_object_end_update (obj);
+    g_assert_cmpuint (above->len, ==, 0);
+    my_object_begin_update (obj);
+    my_object_add (obj, 30);
+    my_object_add (obj, 30);
+    my_object_end_update (obj);
+    g_assert_cmpuint (above->len, ==, 1);
+    g_assert_cmpint (g_array_index (above, gint, 0), ==, 61);
+    
+    /* Removal, also from inside the callback, releases the data */
+    gint n_destroyed = 0;
+    my_object_remove_watch (obj, above_id);
+    guint self_id = my_object_add_watch (obj, MY_WATCH_BELOW, 50, on_watch_remove_self,
+                                         &self_id, NULL);
+    my_object_add_watch (obj, MY_WATCH_ABOVE, G_MAXINT - 1, on_watch_log, above,
+                         on_watch_destroy);
+    my_object_add_watch (obj, MY_WATCH_ABOVE, G_MAXINT - 1, on_watch_log, above,
+                         on_watch_destroy);
+    my_object_set_value (obj, 40);
+    g_assert_cmpuint (self_id, ==, 0);
+    my_object_set_value (obj, 60);
+    my_object_set_value (obj, 40);
+    
+    /* Thresholds at the ends of the range, and equal thresholds */
+    g_array_set_size (above, 0);
+    g_array_set_size (delta, 0);
+    my_object_remove_watch (obj, delta_id);
+    my_object_add_watch (obj, MY_WATCH_DELTA, G_MAXINT, on_watch_log, delta, NULL);
+    my_object_set_value (obj, G_MAXINT);
+    g_assert_cmpuint (above->len, ==, 2);
+    g_assert_cmpuint (delta->len, ==, 0);
+    my_object_set_value (obj, G_MININT);
+    g_assert_cmpuint (delta->len, ==, 1);
+    
+    /* A watch added inside a batch compares against the value the batch
+     * started with, whichever feature first set up the watch state */
+    MyObject *late = my_object_new_with_value (3);
+    g_array_set_size (below, 0);
+    my_object_begin_update (late);
+    my_object_set_value (late, -1);
+    my_object_add_watch (late, MY_WATCH_BELOW, 0, on_watch_log, below, NULL);
+    my_object_end_update (late);
+    g_assert_cmpuint (below->len, ==, 1);
+    g_assert_cmpint (g_array_index (below, gint, 0), ==, -1);
+    g_object_unref (late);
+    
+    /* Many watches, few of them crossed */
+    GArray *many = g_array_new (FALSE, FALSE, sizeof (gint));
+    MyObject *busy = my_object_new ();
+    for (gint i = 0; i < 2000; i++)
+        my_object_add_watch (busy, MY_WATCH_ABOVE, i * 10, on_watch_log, many, NULL);
+    my_object_set_value (busy, 25);
+    g_assert_cmpuint (many->len, ==, 3);
+    my_object_set_value (busy, 24);
+    my_object_set_value (busy, 30);
+    g_assert_cmpuint (many->len, ==, 3);
+    my_object_set_value (busy, 31);
+    g_assert_cmpuint (many->len, ==, 4);
+    
+    g_print ("✓ Watch tests passed\n");
+    
+    g_object_unref (obj);
+    g_assert_cmpint (n_destroyed, ==, 2);
+    g_object_unref (busy);
+    g_array_unref (many);
+    g_array_unref (above);
+    g_array_unref (below);
+    g_array_unref (delta);
+}
+
+/* Test incremental aggregates over a set of objects */
+static void
+test_aggregator (void)
+{
+    g_print ("\n=== Testing Aggregator ===\n");
+    
+    MyObjectAggregator *aggregator = my_object_aggregator_new ();
+    const gint values[] = { 5, -3, 12, 7, 12 };
+    GPtrArray *objects = my_object_new_many (values, NULL, G_N_ELEMENTS (values));
+    
+    g_assert_cmpuint (my_object_aggregator_get_count (aggregator), ==, 0);
+    g_assert_cmpint (my_object_aggregator_get_min (aggregator), ==, 0);
+    
+    for (guint i = 0; i < objects->len; i++)
+        g_assert (my_object_aggregator_add (aggregator, g_ptr_array_index (objects, i)));
+    g_assert (!my_object_aggregator_add (aggregator, g_ptr_array_index (objects, 0)));
+    
+    g_assert_cmpuint (my_object_aggregator_get_count (aggregator), ==, 5);
+    g_assert_cmpint (my_object_aggregator_get_sum (aggregator), ==, 33);
+    g_assert_cmpint (my_object_aggregator_get_min (aggregator), ==, -3);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, 12);
+    
+    /* Equal values rank in the order they were added in */
+    GPtrArray *top = my_object_aggregator_get_top (aggregator, 3);
+    g_assert_cmpuint (top->len, ==, 3);
+    g_assert (g_ptr_array_index (top, 0) == g_ptr_array_index (objects, 2));
+    g_assert (g_ptr_array_index (top, 1) == g_ptr_array_index (objects, 4));
+    g_assert (g_ptr_array_index (top, 2) == g_ptr_array_index (objects, 3));
+    g_ptr_array_unref (top);
+    
+    /* Changes are folded in as they are reported, without handlers */
+    MyObject *first = g_ptr_array_index (objects, 0);
+    my_object_set_value (first, 100);
+    g_assert_cmpint (my_object_aggregator_get_sum (aggregator), ==, 128);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, 100);
+    my_object_add (g_ptr_array_index (objects, 1), -10);
+    g_assert_cmpint (my_object_aggregator_get_min (aggregator), ==, -13);
+    
+    my_object_begin_update (first);
+    my_object_set_value (first, G_MAXINT);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, 100);
+    my_object_end_update (first);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, G_MAXINT);
+    g_assert_cmpint (my_object_aggregator_get_sum (aggregator), ==, (gint64) G_MAXINT + 18);
+    
+    /* Watches and signal handlers still work next to the hook */
+    gint state[2] = { 0, 0 };
+    GArray *fired = g_array_new (FALSE, FALSE, sizeof (gint));
+    g_signal_connect (first, "value-changed", G_CALLBACK (on_value_changed_count), state);
+    guint watch_id = my_object_add_watch (first, MY_WATCH_BELOW, 0, on_watch_log, fired, NULL);
+    my_object_set_value (first, -50);
+    g_assert_cmpint (state[0], ==, 1);
+    g_assert_cmpuint (fired->len, ==, 1);
+    g_assert_cmpint (my_object_aggregator_get_min (aggregator), ==, -50);
+    my_object_remove_watch (first, watch_id);
+    
+    /* Removed members are no longer counted or followed */
+    g_assert (my_object_aggregator_remove (aggregator, first));
+    g_assert (!my_object_aggregator_remove (aggregator, first));
+    g_assert_cmpuint (my_object_aggregator_get_count (aggregator), ==, 4);
+    g_assert_cmpint (my_object_aggregator_get_sum (aggregator), ==, 18);
+    g_assert_cmpint (my_object_aggregator_get_min (aggregator), ==, -13);
+    my_object_set_value (first, 1000);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, 12);
+    
+    /* Members added inside a batch start from the last reported value */
+    g_assert_true (my_object_begin_update (first));
+    my_object_set_value (first, 7);
+    g_assert (my_object_aggregator_add (aggregator, first));
+    my_object_set_value (first, 1000);
+    my_object_end_update (first);
+    g_assert_cmpint (my_object_aggregator_get_sum (aggregator), ==, 1018);
+    g_assert_cmpint (my_object_aggregator_get_max (aggregator), ==, 1000);
+    g_assert (my_object_aggregator_remove (aggregator, first));
+    
+    top = my_object_aggregator_get_top (aggregator, 10);
+    g_assert_cmpuint (top->len, ==, 4);
+    g_assert (g_ptr_array_index (top, 3) == g_ptr_array_index (objects, 1));
+    g_ptr_array_unref (top);
+    
+    g_print ("✓ Aggregator tests passed\n");
+    
+    /* Members outlive the aggregator */
+    g_object_unref (aggregator);
+    my_object_set_value (g_ptr_array_index (objects, 2), 1);
+    g_array_unref (fired);
+    g_ptr_array_unref (objects);
+}
+
+/* Test the name index */
+static void
+test_registry (void)
+{
+    g_print ("\n=== Testing Registry ===\n");
+    
+    MyObjectRegistry *registry = my_object_registry_new ();
+    MyObject *alpha = my_object_new_full (1, "registry-alpha");
+    MyObject *beta = my_object_new_full (2, "registry-beta");
+    MyObject *unnamed = my_object_new_with_value (3);
+    
+    g_assert (my_object_registry_add (registry, alpha));
+    g_assert (my_object_registry_add (registry, beta));
+    g_assert (my_object_registry_add (registry, unnamed));
+    g_assert (!my_object_registry_add (registry, alpha));
+    g_assert_cmpuint (my_object_registry_get_size (registry), ==, 3);
+    
+    g_assert (my_object_registry_lookup (registry, "registry-alpha") == alpha);
+    g_assert (my_object_registry_lookup (registry, "registry-beta") == beta);
+    g_assert (my_object_registry_lookup (registry, "registry-never-used") == NULL);
+    g_assert (g_quark_try_string ("registry-never-used") == 0);
+    
+    /* Renames move members without any help */
+    my_object_set_name (alpha, "registry-gamma");
+    g_assert (my_object_registry_lookup (registry, "registry-alpha") == NULL);
+    g_assert (my_object_registry_lookup (registry, "registry-gamma") == alpha);
+    my_object_set_name (unnamed, "registry-beta");
+    
+    GPtrArray *found = my_object_registry_lookup_all (registry, "registry-beta");
+    g_assert_cmpuint (found->len, ==, 2);
+    g_assert (g_ptr_array_find (found, beta, NULL));
+    g_assert (g_ptr_array_find (found, unnamed, NULL));
+    g_ptr_array_unref (found);
+    
+    my_object_set_name (unnamed, NULL);
+    g_assert (my_object_registry_lookup (registry, "registry-beta") == beta);
+    
+    /* Grow well past the initial table, then check every name */
+    GPtrArray *many = g_ptr_array_new_with_free_func (g_object_unref);
+    for (guint i = 0; i < 500; i++) {
+        gchar *name = g_strdup_printf ("registry-%u", i);
+        MyObject *obj = my_object_new_full ((gint) i, name);
+        
+        my_object_registry_add (registry, obj);
+        g_ptr_array_add (many, obj);
+        g_free (name);
+    }
+    for (guint i = 0; i < 500; i += 7) {
+        gchar *name = g_strdup_printf ("registry-%u", i);
+        
+        g_assert (my_object_registry_lookup (registry, name) == g_ptr_array_index (many, i));
+        g_free (name);
+    }
+    
+    /* Indexing creates no quarks, which would never be freed */
+    g_assert (g_quark_try_string ("registry-499") == 0);
+    g_assert (g_quark_try_string ("registry-gamma") == 0);
+    
+    /* Finalized members leave the index */
+    g_ptr_array_unref (many);
+    g_assert_cmpuint (my_object_registry_get_size (registry), ==, 3);
+    g_assert (my_object_registry_lookup (registry, "registry-42") == NULL);
+    g_object_unref (beta);
+    g_assert (my_object_registry_lookup (registry, "registry-beta") == NULL);
+    g_assert_cmpuint (my_object_registry_get_size (registry), ==, 2);
+    
+    /* Pooled objects lose their name when they are released */
+    MyObjectPool *pool = my_object_pool_new (1);
+    MyObject *pooled = my_object_pool_acquire (pool, 5);
+    my_object_set_name (pooled, "registry-pooled");
+    my_object_registry_add (registry, pooled);
+    g_assert (my_object_registry_lookup (registry, "registry-pooled") == pooled);
+    my_object_pool_release (pool, pooled);
+    g_assert (my_object_registry_lookup (registry, "registry-pooled") == NULL);
+    g_assert (my_object_registry_remove (registry, pooled));
+    g_object_unref (pool);
+    
+    g_assert (my_object_registry_remove (registry, alpha));
+    g_assert (!my_object_registry_remove (registry, alpha));
+    my_object_set_name (alpha, "registry-alpha");
+    g_assert (my_object_registry_lookup (registry, "registry-alpha") == NULL);
+    
+    g_print ("✓ Registry tests passed\n");
+    
+    /* Members outlive the registry */
+    g_object_unref (registry);
+    my_object_set_name (unnamed, "registry-after");
+    g_object_unref (alpha);
+    g_object_unref (unnamed);
+}
+
+/* Test the change journal */
+static void
+test_journal (void)
+{
+    g_print ("\n=== Testing Journal ===\n");
+    
+    MyObjectJournal *journal = my_object_journal_new (6);
+    MyObject *first = my_object_new_full (10, "journal-first");
+    MyObject *second = my_object_new_with_value (20);
+    MyObjectJournalRecord records[8];
+    guint64 sequence = 1;
+    guint n;
+    
+    /* Members start with their current state */
+    guint first_id = my_object_journal_add (journal, first);
+    guint second_id = my_object_journal_add (journal, second);
+    g_assert_cmpuint (first_id, !=, 0);
+    g_assert_cmpuint (second_id, !=, first_id);
+    g_assert_cmpuint (my_object_journal_add (journal, first), ==, first_id);
+    
+    n = my_object_journal_read (journal, &sequence, records, G_N_ELEMENTS (records));
+    g_assert_cmpuint (n, ==, 3);
+    g_assert_cmpuint (sequence, ==, 4);
+    g_assert_cmpuint (records[0].sequence, ==, 1);
+    g_assert_cmpuint (records[0].object_id, ==, first_id);
+    g_assert_cmpint (records[0].field, ==, MY_OBJECT_JOURNAL_VALUE);
+    g_assert_cmpint (records[0].value, ==, 10);
+    g_assert_cmpint (records[1].field, ==, MY_OBJECT_JOURNAL_NAME);
+    g_assert_cmpstr (records[1].name, ==, "journal-first");
+    g_assert_cmpuint (records[2].object_id, ==, second_id);
+    g_assert_cmpint (records[2].value, ==, 20);
+    my_object_journal_clear_records (records, n);
+    g_assert_null (records[1].name);
+    g_assert_cmpuint (my_object_journal_read (journal, &sequence, records, 8), ==, 0);
+    
+    /* Changes are appended in order, batches as one record */
+    my_object_set_value (first, 11);
+    my_object_set_value (first, 11);
+    my_object_set_name (second, "journal-second");
+    my_object_begin_update (second);
+    for (gint i = 0; i < 100; i++)
+        my_object_increment (second);
+    my_object_end_update (second);
+    
+    n = my_object_journal_read (journal, &sequence, records, 2);
+    g_assert_cmpuint (n, ==, 2);
+    g_assert_cmpuint (records[0].sequence, ==, 4);
+    g_assert_cmpint (records[0].value, ==, 11);
+    g_assert_cmpuint (records[1].object_id, ==, second_id);
+    g_assert_cmpstr (records[1].name, ==, "journal-second");
+    my_object_journal_clear_records (records, n);
+    n = my_object_journal_read (journal, &sequence, records, 8);
+    g_assert_cmpuint (n, ==, 1);
+    g_assert_cmpint (records[0].value, ==, 120);
+    g_assert_cmpuint (sequence, ==, my_object_journal_get_next_sequence (journal));
+    
+    /* Consumers read independently, and one that fell behind sees a gap */
+    guint64 late = 1;
+    for (gint i = 0; i < 20; i++)
+        my_object_increment (first);
+    n = my_object_journal_read (journal, &late, records, 8);
+    g_assert_cmpuint (n, ==, 8);
+    g_assert_cmpuint (records[0].sequence, ==, my_object_journal_get_next_sequence (journal) - 8);
+    g_assert_cmpint (records[7].value, ==, 31);
+    g_assert_cmpuint (my_object_journal_read (journal, &sequence, records, 8), ==, 8);
+    g_assert_cmpuint (records[0].sequence, >, 7);
+    
+    /* A pooled member that is recycled records the drop to 0 */
+    MyObjectPool *pool = my_object_pool_new (0);
+    MyObject *pooled = my_object_pool_acquire (pool, 5);
+    my_object_set_name (pooled, "journal-pooled");
+    guint pooled_id = my_object_journal_add (journal, pooled);
+    sequence = my_object_journal_get_next_sequence (journal);
+    my_object_pool_release (pool, pooled);
+    g_assert (my_object_pool_acquire (pool, 0) == pooled);
+    n = my_object_journal_read (journal, &sequence, records, 8);
+    g_assert_cmpuint (n, ==, 2);
+    g_assert_cmpuint (records[0].object_id, ==, pooled_id);
+    g_assert_cmpint (records[0].field, ==, MY_OBJECT_JOURNAL_VALUE);
+    g_assert_cmpint (records[0].value, ==, 0);
+    g_assert_cmpint (records[1].field, ==, MY_OBJECT_JOURNAL_NAME);
+    g_assert_null (records[1].name);
+    my_object_journal_clear_records (records, n);
+    g_assert (my_object_journal_remove (journal, pooled));
+    g_object_unref (pooled);
+    g_object_unref (pool);
+    
+    /* Members added inside a batch start from the last reported value */
+    MyObject *batched = my_object_new_with_value (3);
+    g_assert_true (my_object_begin_update (batched));
+    my_object_set_value (batched, 4);
+    my_object_journal_add (journal, batched);
+    my_object_set_value (batched, 3);
+    my_object_end_update (batched);
+    n = my_object_journal_read (journal, &sequence, records, 8);
+    g_assert_cmpuint (n, ==, 1);
+    g_assert_cmpint (records[0].value, ==, 3);
+    g_object_unref (batched);
+    
+    /* Removed and finalized members are no longer recorded */
+    guint64 next = my_object_journal_get_next_sequence (journal);
+    g_assert (my_object_journal_remove (journal, first));
+    g_assert (!my_object_journal_remove (journal, first));
+    my_object_set_value (first, 0);
+    g_object_unref (second);
+    g_assert_cmpuint (my_object_journal_get_next_sequence (journal), ==, next);
+    
+    g_print ("✓ Journal tests passed\n");
+    
+    /* Members outlive the journal */
+    my_object_journal_add (journal, first);
+    g_object_unref (journal);
+    my_object_set_value (first, 1);
+    g_object_unref (first);
+}
+
+/* Reads a snapshot on another thread */
+static gpointer
+read_snapshot_thread (gpointer data)
+{
+    MyObjectSnapshot *snapshot = data;
+    gint total = 0;
+    
+    for (guint i = 0; i < 1000; i++) {
+        total += my_object_snapshot_get_value (snapshot);
+        total += (gint) strlen (my_object_snapshot_get_name (snapshot));
+    }
+    my_object_snapshot_unref (snapshot);
+    
+    return GINT_TO_POINTER (total);
+}
+
+/* Test snapshots and clones sharing names */
+static void
+test_snapshot_clone (void)
+{
+    g_print ("\n=== Testing Snapshots and Clones ===\n");
+    
+    const gchar *long_name = "a name that is too long to be stored inline";
+    MyObject *obj = my_object_new_full (10, long_name);
+    
+    /* Snapshots share the heap name and do not follow the object */
+    MyObjectSnapshot *snapshot = my_object_snapshot (obj);
+    g_assert_cmpint (my_object_snapshot_get_value (snapshot), ==, 10);
+    g_assert (my_object_snapshot_get_name (snapshot) == my_object_get_name (obj));
+    my_object_set_value (obj, 11);
+    my_object_set_name (obj, "short");
+    g_assert_cmpint (my_object_snapshot_get_value (snapshot), ==, 10);
+    g_assert_cmpstr (my_object_snapshot_get_name (snapshot), ==, long_name);
+    
+    gchar *str = my_object_snapshot_to_string (snapshot);
+    g_assert_cmpstr (str, ==, "MyObject(name='a name that is too long to be stored inline', value=10)");
+    g_free (str);
+    
+    /* Inline names are copied, the snapshot is readable from any thread */
+    MyObjectSnapshot *inline_snapshot = my_object_snapshot (obj);
+    my_object_set_name (obj, "other");
+    g_assert_cmpstr (my_object_snapshot_get_name (inline_snapshot), ==, "short");
+    GThread *thread = g_thread_new ("snapshot-reader", read_snapshot_thread,
+                                    my_object_snapshot_ref (inline_snapshot));
+    g_assert_cmpint (GPOINTER_TO_INT (g_thread_join (thread)), ==, 16000);
+    
+    MyObjectSnapshot *boxed = g_boxed_copy (MY_TYPE_OBJECT_SNAPSHOT, snapshot);
+    g_assert (boxed == snapshot);
+    g_boxed_free (MY_TYPE_OBJECT_SNAPSHOT, boxed);
+    
+    /* Clones share the name until one side writes */
+    my_object_set_name (obj, long_name);
+    MyObject *clone = my_object_clone (obj);
+    g_assert (MY_IS_OBJECT (clone));
+    g_assert_cmpint (my_object_get_value (clone), ==, 11);
+    g_assert (my_object_get_name (clone) == my_object_get_name (obj));
+    my_object_set_name (clone, "another name that is too long to be stored inline");
+    g_assert_cmpstr (my_object_get_name (obj), ==, long_name);
+    my_object_set_value (clone, 12);
+    g_assert_cmpint (my_object_get_value (obj), ==, 11);
+    
+    /* Atomic and pooled sources give plain clones */
+    MyObject *atomic = my_object_new_atomic (5);
+    MyObject *atomic_clone = my_object_clone (atomic);
+    gboolean is_atomic = TRUE;
+    g_object_get (atomic_clone, "atomic", &is_atomic, NULL);
+    g_assert (!is_atomic);
+    g_assert_cmpint (my_object_get_value (atomic_clone), ==, 5);
+    
+    MyObjectPool *pool = my_object_pool_new (1);
+    MyObject *pooled = my_object_pool_acquire (pool, 6);
+    my_object_set_name (pooled, long_name);
+    MyObject *pooled_clone = my_object_clone (pooled);
+    MyObjectSnapshot *pooled_snapshot = my_object_snapshot (pooled);
+    my_object_pool_release (pool, pooled);
+    g_object_unref (pool);
+    g_assert_cmpstr (my_object_get_name (pooled_clone), ==, long_name);
+    g_assert_cmpstr (my_object_snapshot_get_name (pooled_snapshot), ==, long_name);
+    my_object_set_name (pooled_clone, "another name that is too long to be stored inline");
+    g_assert_cmpstr (my_object_snapshot_get_name (pooled_snapshot), ==, long_name);
+    
+    /* Subclasses clone to their own type */
+    MyObject *counter = g_object_new (test_counter_get_type (), "value", 3, NULL);
+    MyObject *counter_clone = my_object_clone (counter);
+    g_assert (G_OBJECT_TYPE (counter_clone) == test_counter_get_type ());
+    g_assert_cmpint (my_object_get_value (counter_clone), ==, 3);
+    
+    g_print ("✓ Snapshot and clone tests passed\n");
+    
+    my_object_snapshot_unref (pooled_snapshot);
+    my_object_snapshot_unref (inline_snapshot);
+    my_object_snapshot_unref (snapshot);
+    g_object_unref (counter_clone);
+    g_object_unref (counter);
+    g_object_unref (pooled_clone);
+    g_object_unref (atomic_clone);
+    g_object_unref (atomic);
+    g_object_unref (clone);
+    g_object_unref (obj);
+}
+
+/* Test serialization and record tables */
+static void
+test_serialization (void)
+{
+    g_print ("\n=== Testing Serialization ===\n");
+    
+    GError *error = NULL;
+    
+    /* Single records round-trip value and name */
+    MyObject *obj = my_object_new_with_value (G_MININT);
+    my_object_set_name (obj, "Serialized");
+    GBytes *bytes = my_object_serialize (obj);
+    g_assert_cmpuint (g_bytes_get_size (bytes), ==, 10 + strlen ("Serialized"));
+    
+    MyObject *copy = my_object_deserialize (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (my_object_get_value (copy), ==, G_MININT);
+    g_assert_cmpstr (my_object_get_name (copy), ==, "Serialized");
+    g_object_unref (copy);
+    
+    /* Truncated records and unknown versions are rejected */
+    GBytes *truncated = g_bytes_new_from_bytes (bytes, 0, 12);
+    g_assert_null (my_object_deserialize (truncated, &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA);
+    g_clear_error (&error);
+    g_bytes_unref (truncated);
+    
+    guint8 future[32];
+    memcpy (future, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+    future[0] = 99;
+    truncated = g_bytes_new (future, g_bytes_get_size (bytes));
+    g_assert_null (my_object_deserialize (truncated, &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_UNSUPPORTED_VERSION);
+    g_clear_error (&error);
+    g_bytes_unref (truncated);
+    g_bytes_unref (bytes);
+    
+    /* Tables are read in place */
+    MyObject *objects[3];
+    objects[0] = obj;
+    objects[1] = my_object_new_with_value (7);
+    objects[2] = my_object_new_with_value (-7);
+    my_object_set_name (objects[2], "");
+    
+    bytes = my_object_table_serialize (objects, G_N_ELEMENTS (objects));
+    MyObjectTable *table = my_object_table_new (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (my_object_table_get_length (table), ==, 3);
+    g_assert_cmpint (my_object_table_get_value (table, 0), ==, G_MININT);
+    g_assert_cmpstr (my_object_table_get_name (table, 0), ==, "Serialized");
+    g_assert_null (my_object_table_get_name (table, 1));
+    g_assert_cmpstr (my_object_table_get_name (table, 2), ==, "");
+    
+    const gchar *data = g_bytes_get_data (bytes, NULL);
+    const gchar *name = my_object_table_get_name (table, 0);
+    g_assert (name > data && name < data + g_bytes_get_size (bytes));
+    
+    guint n_values;
+    const gint *values = my_object_table_get_values (table, &n_values);
+    g_assert_cmpuint (n_values, ==, 3);
+    g_assert_cmpint (values[1], ==, 7);
+    
+    copy = my_object_table_get_object (table, 2);
+    g_assert_cmpint (my_object_get_value (copy), ==, -7);
+    g_assert_cmpstr (my_object_get_name (copy), ==, "");
+    g_object_unref (copy);
+    g_object_unref (table);
+    
+    /* Corrupt headers fail to open */
+    truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) - 1);
+    g_assert_null (my_object_table_new (truncated, &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_INVALID_DATA);
+    g_clear_error (&error);
+    g_bytes_unref (truncated);
+    g_bytes_unref (bytes);
+    
+    /* Arrays serialize their value column */
+    MyObjectArray *array = my_object_array_new ();
+    for (gint i = 0; i < 100; i++)
+        my_object_array_append (array, i * i);
+    bytes = my_object_table_serialize_array (array);
+    table = my_object_table_new (bytes, NULL);
+    g_assert_cmpuint (my_object_table_get_length (table), ==, 100);
+    g_assert_cmpint (my_object_table_get_value (table, 99), ==, 99 * 99);
+    g_assert_null (my_object_table_get_name (table, 99));
+    
+    g_print ("Table of %u records: %" G_GSIZE_FORMAT " bytes\n",
+             my_object_table_get_length (table), g_bytes_get_size (bytes));
+    
+    g_print ("✓ Serialization tests passed\n");
+    
+    g_object_unref (table);
+    g_bytes_unref (bytes);
+    g_object_unref (array);
+    for (guint i = 0; i < G_N_ELEMENTS (objects); i++)
+        g_object_unref (objects[i]);
+}
+
+/* Test the memory-mapped object store */
+static void
+test_object_store (void)
+{
+    g_print ("\n=== Testing Object Store ===\n");
+    
+    GError *error = NULL;
+    gchar *path = NULL;
+    gint fd = g_file_open_tmp ("myobject-store-XXXXXX", &path, &error);
+    g_assert_no_error (error);
+    g_close (fd, NULL);
+    
+    MyObjectStore *store = my_object_store_create (path, 3, 32, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (my_object_store_get_capacity (store), ==, 3);
+    
+    guint index;
+    g_assert (my_object_store_append (store, 10, "first", &index, &error));
+    g_assert_cmpuint (index, ==, 0);
+    g_assert (my_object_store_append (store, 20, NULL, NULL, &error));
+    g_assert (my_object_store_append (store, 30, "third", NULL, &error));
+    g_assert_no_error (error);
+    
+    /* Capacity and heap are fixed */
+    g_assert (!my_object_store_append (store, 40, NULL, NULL, &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE);
+    g_clear_error (&error);
+    g_assert (!my_object_store_set_name (store, 1, "a name that does not fit", &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE);
+    g_clear_error (&error);
+    
+    /* Views read and write the mapped slot and persist their names */
+    gint changed[2] = { 0, 0 };
+    MyObject *view = my_object_store_get_object (store, 0);
+    g_assert_cmpint (my_object_get_value (view), ==, 10);
+    g_assert_cmpstr (my_object_get_name (view), ==, "first");
+    g_signal_connect (view, "value-changed",
+                      G_CALLBACK (on_value_changed_count), changed);
+    
+    my_object_increment (view);
+    g_assert_cmpint (my_object_store_get_value (store, 0), ==, 11);
+    my_object_store_set_value (store, 0, 12);
+    g_assert_cmpint (changed[0], ==, 2);
+    g_assert_cmpint (changed[1], ==, 12);
+    
+    my_object_set_name (view, "one");
+    g_assert_cmpstr (my_object_store_get_name (store, 0), ==, "one");
+    g_assert (my_object_store_set_name (store, 0, "1st", &error));
+    g_assert_cmpstr (my_object_get_name (view), ==, "1st");
+    g_assert (my_object_store_set_name (store, 1, "two", &error));
+    g_assert_no_error (error);
+    
+    /* Renames reuse the heap, so a view can be renamed without end */
+    for (gint i = 0; i < 100; i++) {
+        const gchar *name = i % 2 ? "a longer name" : "short";
+        
+        my_object_set_name (view, name);
+        g_assert_cmpstr (my_object_store_get_name (store, 0), ==, name);
+    }
+    
+    /* A name the heap cannot hold is refused and reported by sync */
+    my_object_set_name (view, "a name that can never fit");
+    g_assert_cmpstr (my_object_get_name (view), ==, "a longer name");
+    g_assert_cmpstr (my_object_store_get_name (store, 0), ==, "a longer name");
+    g_assert (!my_object_store_sync (store, &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE);
+    g_clear_error (&error);
+    my_object_set_name (view, "1st");
+    
+    g_assert (my_object_store_sync (store, &error));
+    g_assert_no_error (error);
+    g_object_unref (store);
+    g_object_unref (view);
+    
+    /* Reopening maps the same records */
+    store = my_object_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (my_object_store_get_length (store), ==, 3);
+    g_assert_cmpint (my_object_store_get_value (store, 0), ==, 12);
+    g_assert_cmpstr (my_object_store_get_name (store, 0), ==, "1st");
+    g_assert_cmpstr (my_object_store_get_name (store, 1), ==, "two");
+    g_assert_cmpstr (my_object_store_get_name (store, 2), ==, "third");
+    g_object_unref (store);
+    
+    /* A store file is also a record table */
+    MyObjectTable *table = my_object_table_new_from_file (path, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (my_object_table_get_length (table), ==, 3);
+    g_assert_cmpint (my_object_table_get_value (table, 2), ==, 30);
+    g_assert_cmpstr (my_object_table_get_name (table, 1), ==, "two");
+    g_object_unref (table);
+    
+    /* Compaction parks a name that overlaps its new place at the free
+     * end, and refuses to start when that end is too small */
+    store = my_object_store_create (path, 2, 22, &error);
+    g_assert_no_error (error);
+    g_assert (my_object_store_append (store, 1, "aaaa", NULL, &error));
+    g_assert (my_object_store_append (store, 2, "bbbbbbb", NULL, &error));
+    g_assert (my_object_store_set_name (store, 0, "dddddddddd", &error));
+    g_assert_no_error (error);
+    g_assert_cmpstr (my_object_store_get_name (store, 0), ==, "dddddddddd");
+    g_assert_cmpstr (my_object_store_get_name (store, 1), ==, "bbbbbbb");
+    g_assert (!my_object_store_set_name (store, 1, "eeeeeeeeee", &error));
+    g_assert_error (error, MY_OBJECT_ERROR, MY_OBJECT_ERROR_NO_SPACE);
+    g_clear_error (&error);
+    g_assert_cmpstr (my_object_store_get_name (store, 0), ==, "dddddddddd");
+    g_assert_cmpstr (my_object_store_get_name (store, 1), ==, "bbbbbbb");
+    g_object_unref (store);
+    
+    g_print ("✓ Object store tests passed\n");
+    
+    g_unlink (path);
+    g_free (path);
+}
+
 /* Test reference counting */
 static void
 test_reference_counting (void)
@@ -159,6 +2051,11 @@ test_type_system (void)
     g_assert (g_type_is_a (type, G_TYPE_OBJECT));
     g_assert_cmpstr (g_type_name (type), ==, "MyObject");
     
+    /* ABI 2: the instance is just the GObject header */
+    GTypeQuery query;
+    g_type_query (type, &query);
+    g_assert_cmpuint (query.instance_size, ==, sizeof (GObject));
+    
     /* Test type checking macros */
     MyObject *obj = my_object_new ();
     g_assert (MY_IS_OBJECT (obj));
@@ -185,9 +2082,31 @@ main (int argc, char *argv[])
     
     /* Run all tests */
     test_object_creation ();
+    test_new_many ();
     test_properties ();
+    test_name_storage ();
     test_methods ();
     test_signals ();
+    test_signal_fast_path ();
+    test_batch_update ();
+    test_atomic_mode ();
+    test_sharded_mode ();
+    test_notify_context ();
+    test_watches ();
+    test_aggregator ();
+    test_registry ();
+    test_journal ();
+    test_object_array ();
+    test_array_parallel ();
+    test_object_pool ();
+    test_transaction ();
+    test_snapshot_clone ();
+    test_serialization ();
+    test_object_store ();
+    test_inline_accessors ();
+    test_value_struct ();
+    test_stats ();
+    test_allocation_contracts ();
     test_reference_counting ();
     test_type_system ();
     